@@ -0,0 +1,803 @@
+/*
+  ==============================================================================
+
+    Biquad cascade engine: a whole MonoChain worth of second order sections,
+    plus the parametric bands, for any number of channels, processed on SIMD
+    registers.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <algorithm>
+#include <array>
+#include <utility>
+#include <vector>
+
+// BPR -> plain normalised biquad (a0 == 1), cheap to copy around without touching the heap.
+// Designed in double, every engine rounds it to its own sample type when it loads it.
+
+struct BiquadCoefficients
+{
+    double b0 { 1.0 }, b1 { 0.0 }, b2 { 0.0 }, a1 { 0.0 }, a2 { 0.0 };
+
+    // The zeros cancel the poles exactly and the gain is one, e.g. a peak or shelf at 0 dB.
+    // Such a section passes its input through unchanged, and started from silence its TDF2
+    // state stays at zero. Checked at float precision, the coarsest an engine runs at, so it
+    // holds for all of them.
+    bool isTransparent() const
+    {
+        return (float)b0 == 1.f && (float)b1 == (float)a1 && (float)b2 == (float)a2;
+    }
+
+    bool operator==(const BiquadCoefficients& other) const
+    {
+        return b0 == other.b0 && b1 == other.b1 && b2 == other.b2 && a1 == other.a1 && a2 == other.a2;
+    }
+
+    bool operator!=(const BiquadCoefficients& other) const { return ! (*this == other); }
+};
+
+enum class BiquadProcessingMode
+{
+    perSample,
+    blockStateSpace
+};
+
+// BPR -> Same transposed direct form II as juce::dsp::IIR::Filter, but every channel lives
+// in one lane of a SIMDRegister and shares the (broadcast) coefficients, so one set of
+// instructions runs Register::size() channels. Layouts wider than that (5.1, 7.1, 7.1.4)
+// are split into lane groups of Register::size() channels, each with its own state, so the
+// cost grows with the number of groups rather than the number of channels.
+//
+// The positions (nine for the MonoChain, then one per parametric band) are only bookkeeping:
+// the enabled ones are packed, in chain order, into structure of arrays storage, one array
+// per coefficient and per state variable, and the sample loop walks just the packed part.
+// Bypassing a position repacks the arrays instead of adding a branch, so disabled bands
+// cost nothing in the sample loop. Positions whose coefficients are transparent in every lane
+// are left out the same way.
+//
+// A section that drops out still holds state on the order of the signal (a 20 Hz high pass
+// carrying bass, say), and one that comes in changes the response in a single step. So once
+// the cascade is running, any change to the set of running sections, or a lane of a running
+// section switching to or from transparent, keeps the previous packed sections going, state
+// and all, and crossfades from them to the new set over crossfadeSeconds. Only then are they
+// dropped. A change during a crossfade leaves the sections being faded out as they are.
+//
+// The sample loop itself is instantiated once per possible number of packed sections, up to
+// maxUnrolledSections, and picked from a function table once per block. Whatever the low cut
+// / high cut slopes and the peak band state are, the packed arrays only differ in their
+// length, so the 32 slope and peak combinations share the kernels for 2 to 9 sections.
+// Inside a kernel the section count is a compile time constant: the stages are fully
+// unrolled and their state sits in locals. Longer chains (many parametric bands) run one
+// loop over the packed arrays instead.
+//
+// ProcessingMode::blockStateSpace is an alternative chosen in prepare(): every section is
+// recast in state space form, y = C x + D u, x' = A x + B u, and advanced Register::size()
+// samples at a time. The outputs of one such block are a small matrix times (state, inputs),
+// computed with the block's samples in the SIMD lanes, and the recursion only has to carry
+// the two state values from one block to the next instead of from sample to sample. Those
+// come straight out of the last two outputs of the block, exactly as the plain recursion
+// would have produced them.
+// Channels are then handled one after the other, and both modes share the same state.
+//
+// Coefficients are normally the same in every lane, but a lane can also be given its own.
+// Mid/side processing uses that: with setMidSide(true) a stereo block is encoded to M/S while
+// it is interleaved, the mid runs in lane 0 and the side in lane 1 with their own
+// coefficients, and the result is decoded back to L/R while it is deinterleaved. The matrix
+// costs nothing beyond the copies the cascade does anyway. Mid/side always runs the per sample
+// kernels, the state space matrices assume the same coefficients in every lane.
+//
+// The engine is a template on the sample type: BiquadCascade is the float one, and
+// BasicBiquadCascade<double> runs the double precision path with half as many lanes.
+//
+// process() can also take a gain ramp for the whole block. It is applied while the samples are
+// copied back out of the interleaved buffer, so an output gain adds no pass of its own, and
+// unlike a gain folded into the coefficients it never touches the filter state.
+//
+// When the cascade hands sections over to another engine in front of it, the sections being
+// crossfaded out of and the ones coming in see different signals: process() can take a
+// separate input for the outgoing sections, and beginCrossfade() starts a crossfade that no
+// change of the sections would start on its own.
+
+template<typename SampleType>
+struct BasicBiquadCascade
+{
+    using Register = juce::dsp::SIMDRegister<SampleType>;
+
+    static constexpr int maxMonoChainSections = 9;
+    static constexpr int maxParametricBands = 16;
+    static constexpr int maxSections = maxMonoChainSections + maxParametricBands;
+    static constexpr int maxUnrolledSections = 12;
+    static constexpr int numLanes = (int)Register::size();
+    static constexpr int allLanes = -1;
+    static constexpr double crossfadeSeconds = 0.005;
+
+    using ProcessingMode = BiquadProcessingMode;
+
+    static_assert(numLanes >= 2, "mid/side needs a lane each for the mid and the side");
+
+    void prepare(const juce::dsp::ProcessSpec& spec, ProcessingMode modeToUse = ProcessingMode::perSample)
+    {
+        const auto numGroups = juce::jmax(1, ((int)spec.numChannels + numLanes - 1) / numLanes);
+
+        interleaved.resize(spec.maximumBlockSize);
+        outgoingFrames.resize(spec.maximumBlockSize);
+        groups.resize((size_t)numGroups);
+        outgoing.resize((size_t)numGroups);
+        fadeLength = juce::jmax(1, juce::roundToInt(spec.sampleRate * crossfadeSeconds));
+        mode = modeToUse;
+        needsRepacking = true;
+        reset();
+    }
+
+    // Back to silence, with nothing left to crossfade from
+    void reset()
+    {
+        for (auto& sections : groups)
+        {
+            sections.s1.fill(Register::expand(0));
+            sections.s2.fill(Register::expand(0));
+        }
+
+        fadeRemaining = 0;
+        running = false;
+    }
+
+    void setCoefficients(int index, const BiquadCoefficients& coefficients, int lane = allLanes)
+    {
+        auto& position = positions[(size_t)index];
+
+        // A lane of a running section turning into a plain pass through, or back, is as much
+        // of a step as the section coming or going
+        if (position.isActive())
+        {
+            const auto flips = [&](size_t l) { return position.coefficients[l].isTransparent() != coefficients.isTransparent(); };
+            auto anyFlips = false;
+
+            for (size_t l = 0; l < (size_t)numLanes; ++l)
+                anyFlips = anyFlips || ((lane == allLanes || (size_t)lane == l) && flips(l));
+
+            if (anyFlips)
+                beginCrossfade();
+        }
+
+        if (lane == allLanes)
+            position.coefficients.fill(coefficients);
+        else
+            position.coefficients[(size_t)lane] = coefficients;
+
+        const auto transparent = std::all_of(position.coefficients.begin(), position.coefficients.end(),
+                                             [](const BiquadCoefficients& c) { return c.isTransparent(); });
+
+        if (transparent != position.transparent)
+        {
+            if (! position.bypassed)
+                beginCrossfade();
+
+            position.transparent = transparent;
+            needsRepacking = true;
+        }
+
+        if (position.activeIndex >= 0)
+        {
+            for (auto& sections : groups)
+                loadCoefficients(sections, position.activeIndex, position.coefficients);
+
+            if (mode == ProcessingMode::blockStateSpace)
+                computeStateSpace(stateSpace[(size_t)position.activeIndex], position.coefficients[0]);
+        }
+    }
+
+    // Only used for stereo blocks, anything else keeps its channels as they are
+    void setMidSide(bool shouldUseMidSide) { midSide = shouldUseMidSide; }
+
+    // Both modes run on the same section state, so this can switch between any two blocks
+    void setProcessingMode(ProcessingMode newMode)
+    {
+        if (newMode == mode)
+            return;
+
+        mode = newMode;
+
+        if (mode == ProcessingMode::blockStateSpace && ! needsRepacking)
+            for (auto& position : positions)
+                if (position.activeIndex >= 0)
+                    computeStateSpace(stateSpace[(size_t)position.activeIndex], position.coefficients[0]);
+    }
+
+    void setBypassed(int index, bool shouldBeBypassed)
+    {
+        auto& position = positions[(size_t)index];
+
+        if (position.bypassed != shouldBeBypassed)
+        {
+            if (! position.transparent)
+                beginCrossfade();
+
+            position.bypassed = shouldBeBypassed;
+            needsRepacking = true;
+        }
+    }
+
+    bool isBypassed(int index) const { return positions[(size_t)index].bypassed; }
+    int getNumActiveSections() const { return numActive; }
+
+    const BiquadCoefficients& getCoefficients(int index, int lane = 0) const
+    {
+        return positions[(size_t)index].coefficients[(size_t)lane];
+    }
+
+    // Crossfades from the sections running now to whatever they are changed to before the next
+    // block, even to the same ones. Called before the change is made. Before the first block
+    // after a reset, and during another crossfade, it leaves things as they are.
+    void beginCrossfade()
+    {
+        if (! running || fadeRemaining > 0)
+            return;
+
+        outgoing = groups;
+        numOutgoing = numActive;
+        fadeRemaining = fadeLength;
+    }
+
+    bool isCrossfading() const { return fadeRemaining > 0; }
+
+    // Every position is bypassed or transparent and no crossfade is left to finish,
+    // process() would leave the block as it is
+    bool isTransparent() const
+    {
+        return fadeRemaining == 0
+            && std::none_of(positions.begin(), positions.end(), [](const Position& p) { return p.isActive(); });
+    }
+
+    // Channel c runs in lane c % numLanes of group c / numLanes, lanes without a channel
+    // (e.g. the second to fourth lane of a mono block) just run on silence. The output gain
+    // moves linearly from gainStart to gainEnd over the block, like AudioBuffer::applyGainRamp.
+    void process(const juce::dsp::AudioBlock<SampleType>& block, float gainStart = 1.f, float gainEnd = 1.f)
+    {
+        process(block, block, gainStart, gainEnd);
+    }
+
+    // Same, with the sections being crossfaded out of running on outgoingInput instead of on
+    // block, which takes the output as usual. Outside a crossfade outgoingInput isn't read.
+    void process(const juce::dsp::AudioBlock<SampleType>& block, const juce::dsp::AudioBlock<SampleType>& outgoingInput,
+                 float gainStart = 1.f, float gainEnd = 1.f)
+    {
+        const auto numChannels = juce::jmin((int)block.getNumChannels(), (int)groups.size() * numLanes);
+        const auto numSamples = (int)block.getNumSamples();
+        const auto capacity = (int)interleaved.size();
+
+        if (needsRepacking)
+            repack();
+
+        running = true;
+
+        if (numChannels == 0 || capacity == 0 || numSamples == 0)
+            return;
+
+        const GainRamp gain { (SampleType)gainStart, (SampleType)(gainEnd - gainStart) / (SampleType)numSamples };
+        const auto fading = fadeRemaining > 0;
+
+        // No section to run, the gain is all there is to do
+        if (numActive == 0 && ! fading)
+        {
+            if (! gain.isUnity())
+                for (int ch = 0; ch < numChannels; ++ch)
+                    gain.apply(block.getChannelPointer((size_t)ch), 0, numSamples);
+
+            return;
+        }
+
+        const auto encodeMidSide = midSide && numChannels == 2;
+        const auto separateOutgoing = fading && outgoingInput.getChannelPointer(0) != block.getChannelPointer(0);
+
+        jassert(! separateOutgoing || outgoingInput.getNumSamples() >= block.getNumSamples());
+
+        // Both modes keep the same state, a crossfade runs the per sample kernels for a while
+        if (mode == ProcessingMode::blockStateSpace && ! encodeMidSide && ! fading)
+        {
+            for (int ch = 0; ch < numChannels; ++ch)
+                for (int start = 0; start < numSamples; start += capacity)
+                    processStateSpace(block.getChannelPointer((size_t)ch), start, ch, juce::jmin(capacity, numSamples - start), gain);
+
+            return;
+        }
+
+        const auto kernel = getKernel(numActive);
+
+        for (int group = 0; group * numLanes < numChannels; ++group)
+        {
+            std::array<SampleType*, numLanes> channels {}, outgoingChannels {};
+
+            for (int lane = 0; lane < numLanes && group * numLanes + lane < numChannels; ++lane)
+                channels[(size_t)lane] = block.getChannelPointer((size_t)(group * numLanes + lane));
+
+            if (separateOutgoing)
+                for (int lane = 0; lane < numLanes && group * numLanes + lane < (int)outgoingInput.getNumChannels(); ++lane)
+                    outgoingChannels[(size_t)lane] = outgoingInput.getChannelPointer((size_t)(group * numLanes + lane));
+
+            for (int start = 0; start < numSamples; start += capacity)
+            {
+                const auto num = juce::jmin(capacity, numSamples - start);
+
+                if (encodeMidSide)
+                    interleaveMidSide(channels, start, num, interleaved);
+                else
+                    interleave(channels, start, num, interleaved);
+
+                if (fading)
+                {
+                    if (! separateOutgoing)
+                        std::copy_n(interleaved.begin(), num, outgoingFrames.begin());
+                    else if (encodeMidSide)
+                        interleaveMidSide(outgoingChannels, start, num, outgoingFrames);
+                    else
+                        interleave(outgoingChannels, start, num, outgoingFrames);
+
+                    getKernel(numOutgoing)(outgoing[(size_t)group], outgoingFrames.data(), num, numOutgoing);
+                }
+
+                kernel(groups[(size_t)group], interleaved.data(), num, numActive);
+
+                if (fading)
+                    mixOutgoing(start, num);
+
+                if (encodeMidSide)
+                    deinterleaveMidSide(channels, start, num, gain);
+                else
+                    deinterleave(channels, start, num, gain);
+            }
+        }
+
+        fadeRemaining = juce::jmax(0, fadeRemaining - numSamples);
+    }
+
+private:
+    // Linear output gain, sample i of the block gets start + step * i
+    struct GainRamp
+    {
+        SampleType start, step;
+
+        SampleType at(int i) const noexcept { return start + step * (SampleType)i; }
+        bool isUnity() const noexcept { return start == (SampleType)1 && step == (SampleType)0; }
+
+        void apply(SampleType* data, int offset, int num) const noexcept
+        {
+            for (int i = offset; i < offset + num; ++i)
+                data[i] *= at(i);
+        }
+    };
+
+    // Structure of arrays, entry i of every array belongs to packed section i
+    struct PackedSections
+    {
+        std::array<Register, maxSections> b0, b1, b2, a1, a2;
+        std::array<Register, maxSections> s1, s2;
+    };
+
+    static constexpr int blockLength = (int)Register::size();
+
+    static_assert(blockLength >= 2, "the state is recovered from the last two outputs of a block");
+
+    // One section rounded to the sample type, for the scalar recursions
+    struct SectionCoefficients
+    {
+        SampleType b0, b1, b2, a1, a2;
+
+        explicit SectionCoefficients(const BiquadCoefficients& c = {})
+            : b0((SampleType)c.b0), b1((SampleType)c.b1), b2((SampleType)c.b2), a1((SampleType)c.a1), a2((SampleType)c.a2) {}
+    };
+
+    // y[0..blockLength) = o1 * s1 + o2 * s2 + sum_j t[j] * u[j], lanes are time
+    struct StateSpaceSection
+    {
+        Register o1, o2;
+        std::array<Register, blockLength> t;
+        SectionCoefficients coefficients;
+    };
+
+    struct Position
+    {
+        std::array<BiquadCoefficients, numLanes> coefficients;
+        bool bypassed = true, transparent = true;
+        int activeIndex = -1;
+
+        bool isActive() const { return ! bypassed && ! transparent; }
+    };
+
+    // One set of packed arrays per lane group, only the first numActive entries are live, in chain order
+    std::vector<PackedSections> groups { 1 };
+    int numActive = 0;
+
+    std::array<Position, maxSections> positions;
+    bool needsRepacking = false;
+
+    ProcessingMode mode = ProcessingMode::perSample;
+    bool midSide = false;
+    std::array<StateSpaceSection, maxSections> stateSpace;
+
+    std::vector<Register> interleaved;
+
+    // The sections being crossfaded out of, with their own state, for fadeRemaining more samples
+    std::vector<PackedSections> outgoing { 1 };
+    std::vector<Register> outgoingFrames;
+    int numOutgoing = 0, fadeLength = 1, fadeRemaining = 0;
+
+    // Set by process(), a change before the first block after a reset needs no crossfade
+    bool running = false;
+
+    // Linear from the outgoing sections to the current ones, sample start of the block is
+    // fadeRemaining - start samples before the end of the crossfade
+    void mixOutgoing(int start, int num)
+    {
+        const auto scale = (SampleType)1 / (SampleType)fadeLength;
+
+        for (int i = 0; i < num && fadeRemaining - (start + i) > 0; ++i)
+        {
+            const auto outgoingGain = (SampleType)(fadeRemaining - (start + i)) * scale;
+            interleaved[(size_t)i] = interleaved[(size_t)i] + ((outgoingFrames[(size_t)i] - interleaved[(size_t)i]) * outgoingGain);
+        }
+    }
+
+    static void loadCoefficients(PackedSections& sections, int index, const std::array<BiquadCoefficients, numLanes>& coefficients)
+    {
+        const auto i = (size_t)index;
+
+        for (size_t lane = 0; lane < (size_t)numLanes; ++lane)
+        {
+            const auto& c = coefficients[lane];
+
+            sections.b0[i].set(lane, (SampleType)c.b0);
+            sections.b1[i].set(lane, (SampleType)c.b1);
+            sections.b2[i].set(lane, (SampleType)c.b2);
+            sections.a1[i].set(lane, (SampleType)c.a1);
+            sections.a2[i].set(lane, (SampleType)c.a2);
+        }
+    }
+
+    void repack()
+    {
+        // Sections that stay enabled keep their state, newly enabled ones start from silence
+        for (auto& sections : groups)
+        {
+            PackedSections packed;
+            int numPacked = 0;
+
+            for (auto& position : positions)
+            {
+                if (! position.isActive())
+                    continue;
+
+                const auto i = (size_t)numPacked;
+                loadCoefficients(packed, numPacked++, position.coefficients);
+
+                if (position.activeIndex >= 0)
+                {
+                    packed.s1[i] = sections.s1[(size_t)position.activeIndex];
+                    packed.s2[i] = sections.s2[(size_t)position.activeIndex];
+                }
+                else
+                {
+                    packed.s1[i] = Register::expand(0);
+                    packed.s2[i] = Register::expand(0);
+                }
+            }
+
+            sections = packed;
+        }
+
+        int numPacked = 0;
+
+        for (auto& position : positions)
+            position.activeIndex = position.isActive() ? numPacked++ : -1;
+
+        numActive = numPacked;
+        needsRepacking = false;
+
+        if (mode == ProcessingMode::blockStateSpace)
+            for (auto& position : positions)
+                if (position.activeIndex >= 0)
+                    computeStateSpace(stateSpace[(size_t)position.activeIndex], position.coefficients[0]);
+    }
+
+    static void computeStateSpace(StateSpaceSection& m, const BiquadCoefficients& coefficients)
+    {
+        // From the rounded coefficients, the same ones the per sample kernels run
+        const SectionCoefficients c(coefficients);
+
+        // Transposed direct form II as state space:
+        // A = [-a1 1; -a2 0], B = [b1 - a1 b0; b2 - a2 b0], C = [1 0], D = b0
+        const double a00 = -c.a1, a10 = -c.a2;
+        const double bIn0 = (double)c.b1 - (double)c.a1 * c.b0;
+        const double bIn1 = (double)c.b2 - (double)c.a2 * c.b0;
+
+        // Rows C A^k for k = 0 .. blockLength - 1
+        std::array<double, blockLength> row0, row1;
+        double p0 = 1, p1 = 0;
+
+        for (int k = 0; k < blockLength; ++k)
+        {
+            row0[(size_t)k] = p0;
+            row1[(size_t)k] = p1;
+
+            // [p0 p1] = [p0 p1] A
+            const auto n0 = p0 * a00 + p1 * a10;
+            p1 = p0;
+            p0 = n0;
+        }
+
+        m.coefficients = c;
+
+        for (int k = 0; k < blockLength; ++k)
+        {
+            m.o1.set((size_t)k, (SampleType)row0[(size_t)k]);
+            m.o2.set((size_t)k, (SampleType)row1[(size_t)k]);
+        }
+
+        // Impulse response within the block: D on the diagonal, C A^(k - j - 1) B below it
+        for (int j = 0; j < blockLength; ++j)
+        {
+            for (int k = 0; k < blockLength; ++k)
+            {
+                double h = 0.0;
+
+                if (k == j)
+                    h = c.b0;
+                else if (k > j)
+                    h = row0[(size_t)(k - j - 1)] * bIn0 + row1[(size_t)(k - j - 1)] * bIn1;
+
+                m.t[(size_t)j].set((size_t)k, (SampleType)h);
+            }
+        }
+    }
+
+    void processStateSpace(SampleType* channelData, int start, int channel, int num, const GainRamp& gain)
+    {
+        auto& sections = groups[(size_t)(channel / numLanes)];
+        const auto lane = (size_t)(channel % numLanes);
+        auto* data = channelData + start;
+
+        // Aligned copy so every block of blockLength samples is one register load / store
+        auto* frames = reinterpret_cast<SampleType*>(interleaved.data());
+        std::copy(data, data + num, frames);
+
+        std::array<SampleType, maxSections> s1, s2;
+
+        for (int s = 0; s < numActive; ++s)
+        {
+            s1[(size_t)s] = sections.s1[(size_t)s].get(lane);
+            s2[(size_t)s] = sections.s2[(size_t)s].get(lane);
+        }
+
+        const auto numBlocks = num / blockLength;
+
+        // Block by block through all sections, so the short state recursion of one section
+        // overlaps with the matrix work of the next one
+        for (int b = 0; b < numBlocks; ++b)
+        {
+            auto* frame = frames + b * blockLength;
+            auto u = Register::fromRawArray(frame);
+
+            for (int s = 0; s < numActive; ++s)
+            {
+                const auto& m = stateSpace[(size_t)s];
+                const auto& c = m.coefficients;
+
+                // The input part doesn't depend on the state
+                auto y = m.t[0] * u.get(0);
+
+                for (int j = 1; j < blockLength; ++j)
+                    y += m.t[(size_t)j] * u.get((size_t)j);
+
+                y += (m.o1 * s1[(size_t)s]) + (m.o2 * s2[(size_t)s]);
+
+                // s2 = b2 u - a2 y and s1 = b1 u - a1 y + previous s2, over the last two samples
+                const auto uLast = u.get(blockLength - 1), uBefore = u.get(blockLength - 2);
+                const auto yLast = y.get(blockLength - 1), yBefore = y.get(blockLength - 2);
+
+                s2[(size_t)s] = (uLast * c.b2) - (yLast * c.a2);
+                s1[(size_t)s] = (uLast * c.b1) - (yLast * c.a1) + ((uBefore * c.b2) - (yBefore * c.a2));
+
+                u = y;
+            }
+
+            u.copyToRawArray(frame);
+        }
+
+        // Leftover samples that don't fill a whole block run the plain recursion
+        for (int s = 0; s < numActive; ++s)
+        {
+            const auto& c = stateSpace[(size_t)s].coefficients;
+            auto z1 = s1[(size_t)s], z2 = s2[(size_t)s];
+
+            for (int i = numBlocks * blockLength; i < num; ++i)
+            {
+                const auto x = frames[i];
+                const auto y = (x * c.b0) + z1;
+                z1 = (x * c.b1) - (y * c.a1) + z2;
+                z2 = (x * c.b2) - (y * c.a2);
+                frames[i] = y;
+            }
+
+            sections.s1[(size_t)s].set(lane, z1);
+            sections.s2[(size_t)s].set(lane, z2);
+        }
+
+        if (gain.isUnity())
+            std::copy(frames, frames + num, data);
+        else
+            for (int i = 0; i < num; ++i)
+                data[i] = frames[i] * gain.at(start + i);
+    }
+
+    // One channel at a time, so every channel is read and written sequentially
+    void interleave(const std::array<SampleType*, numLanes>& channels, int start, int num, std::vector<Register>& destination)
+    {
+        auto* frames = reinterpret_cast<SampleType*>(destination.data());
+
+        for (int lane = 0; lane < numLanes; ++lane)
+        {
+            const auto* source = channels[(size_t)lane];
+
+            if (source == nullptr)
+                for (int i = 0; i < num; ++i)
+                    frames[i * numLanes + lane] = 0;
+            else
+                for (int i = 0; i < num; ++i)
+                    frames[i * numLanes + lane] = source[start + i];
+        }
+    }
+
+    void deinterleave(const std::array<SampleType*, numLanes>& channels, int start, int num, const GainRamp& gain) const
+    {
+        auto* frames = reinterpret_cast<const SampleType*>(interleaved.data());
+
+        for (int lane = 0; lane < numLanes; ++lane)
+        {
+            auto* destination = channels[(size_t)lane];
+
+            if (destination == nullptr)
+                continue;
+
+            if (gain.isUnity())
+                for (int i = 0; i < num; ++i)
+                    destination[start + i] = frames[i * numLanes + lane];
+            else
+                for (int i = 0; i < num; ++i)
+                    destination[start + i] = frames[i * numLanes + lane] * gain.at(start + i);
+        }
+    }
+
+    // L/R in, M/S in lanes 0 and 1 out, the other lanes stay silent
+    void interleaveMidSide(const std::array<SampleType*, numLanes>& channels, int start, int num, std::vector<Register>& destination)
+    {
+        auto* frames = reinterpret_cast<SampleType*>(destination.data());
+        const auto* left = channels[0] + start;
+        const auto* right = channels[1] + start;
+
+        for (int i = 0; i < num; ++i)
+        {
+            auto* frame = frames + i * numLanes;
+
+            frame[0] = (left[i] + right[i]) * (SampleType)0.5;
+            frame[1] = (left[i] - right[i]) * (SampleType)0.5;
+
+            for (int lane = 2; lane < numLanes; ++lane)
+                frame[lane] = 0;
+        }
+    }
+
+    void deinterleaveMidSide(const std::array<SampleType*, numLanes>& channels, int start, int num, const GainRamp& gain) const
+    {
+        auto* frames = reinterpret_cast<const SampleType*>(interleaved.data());
+        auto* left = channels[0] + start;
+        auto* right = channels[1] + start;
+
+        for (int i = 0; i < num; ++i)
+        {
+            const auto g = gain.at(start + i);
+            const auto mid = frames[i * numLanes] * g;
+            const auto side = frames[i * numLanes + 1] * g;
+
+            left[i] = mid + side;
+            right[i] = mid - side;
+        }
+    }
+
+    // Local copy of the first NumSections packed sections, for the unrolled kernels
+    template<int NumSections>
+    struct LocalSections
+    {
+        std::array<Register, NumSections> b0, b1, b2, a1, a2, s1, s2;
+    };
+
+    template<size_t Index, typename Sections>
+    static forcedinline Register processSection(Sections& sections, Register x) noexcept
+    {
+        // Same operation order as juce::dsp::IIR::Filter, so every lane matches it bit for bit
+        auto y = (x * std::get<Index>(sections.b0)) + std::get<Index>(sections.s1);
+        std::get<Index>(sections.s1) = (x * std::get<Index>(sections.b1)) - (y * std::get<Index>(sections.a1)) + std::get<Index>(sections.s2);
+        std::get<Index>(sections.s2) = (x * std::get<Index>(sections.b2)) - (y * std::get<Index>(sections.a2));
+        return y;
+    }
+
+    template<int NumSections, size_t... Index>
+    static forcedinline Register processSections(LocalSections<NumSections>& local,
+                                                 Register x,
+                                                 std::index_sequence<Index...>) noexcept
+    {
+        ((x = processSection<Index>(local, x)), ...);
+        return x;
+    }
+
+    template<int NumSections>
+    static void processKernel(PackedSections& packed, Register* frames, int num, int numSections)
+    {
+        jassert(numSections == NumSections);
+        juce::ignoreUnused(numSections);
+
+        if constexpr (NumSections > 0)
+        {
+            LocalSections<NumSections> local;
+
+            std::copy_n(packed.b0.begin(), NumSections, local.b0.begin());
+            std::copy_n(packed.b1.begin(), NumSections, local.b1.begin());
+            std::copy_n(packed.b2.begin(), NumSections, local.b2.begin());
+            std::copy_n(packed.a1.begin(), NumSections, local.a1.begin());
+            std::copy_n(packed.a2.begin(), NumSections, local.a2.begin());
+            std::copy_n(packed.s1.begin(), NumSections, local.s1.begin());
+            std::copy_n(packed.s2.begin(), NumSections, local.s2.begin());
+
+            for (int i = 0; i < num; ++i)
+                frames[i] = processSections(local, frames[i], std::make_index_sequence<NumSections>());
+
+            std::copy(local.s1.begin(), local.s1.end(), packed.s1.begin());
+            std::copy(local.s2.begin(), local.s2.end(), packed.s2.begin());
+        }
+        else
+        {
+            juce::ignoreUnused(packed, frames, num);
+        }
+    }
+
+    // Longer chains: one tight loop over the packed arrays
+    static void processLoopKernel(PackedSections& packed, Register* frames, int num, int numSections)
+    {
+        for (int i = 0; i < num; ++i)
+        {
+            auto x = frames[i];
+
+            for (size_t s = 0; s < (size_t)numSections; ++s)
+            {
+                const auto y = (x * packed.b0[s]) + packed.s1[s];
+                packed.s1[s] = (x * packed.b1[s]) - (y * packed.a1[s]) + packed.s2[s];
+                packed.s2[s] = (x * packed.b2[s]) - (y * packed.a2[s]);
+                x = y;
+            }
+
+            frames[i] = x;
+        }
+    }
+
+    using Kernel = void (*)(PackedSections&, Register*, int, int);
+
+    static Kernel getKernel(int numSections)
+    {
+        static constexpr Kernel kernels[] =
+        {
+            &processKernel<0>, &processKernel<1>, &processKernel<2>, &processKernel<3>, &processKernel<4>,
+            &processKernel<5>, &processKernel<6>, &processKernel<7>, &processKernel<8>, &processKernel<9>,
+            &processKernel<10>, &processKernel<11>, &processKernel<12>
+        };
+
+        static_assert(std::size(kernels) == maxUnrolledSections + 1, "one kernel per unrolled section count");
+
+        return numSections <= maxUnrolledSections ? kernels[numSections] : &processLoopKernel;
+    }
+};
+
+using BiquadCascade = BasicBiquadCascade<float>;
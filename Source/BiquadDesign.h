@@ -0,0 +1,234 @@
+/*
+  ==============================================================================
+
+    Closed form biquad designs that write straight into BiquadCoefficients,
+    without allocating, so they can run on the audio thread.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "BiquadCascade.h"
+
+#include <array>
+#include <cmath>
+#include <complex>
+
+// BPR -> Same formulas as juce::dsp::IIR::Coefficients / FilterDesign, evaluated in double
+// and normalised by a0 before they are stored.
+
+namespace BiquadDesign
+{
+    inline BiquadCoefficients normalise(double b0, double b1, double b2, double a0, double a1, double a2)
+    {
+        const auto a0Inv = 1.0 / a0;
+
+        return { b0 * a0Inv, b1 * a0Inv, b2 * a0Inv, a1 * a0Inv, a2 * a0Inv };
+    }
+
+    inline BiquadCoefficients makePeak(double sampleRate, double frequency, double quality, double gainFactor)
+    {
+        const auto A = juce::jmax(0.0, std::sqrt(gainFactor));
+        const auto omega = juce::MathConstants<double>::twoPi * juce::jmax(frequency, 2.0) / sampleRate;
+        const auto alpha = std::sin(omega) / (quality * 2.0);
+        const auto c2 = -2.0 * std::cos(omega);
+        const auto alphaTimesA = alpha * A;
+        const auto alphaOverA = alpha / A;
+
+        return normalise(1.0 + alphaTimesA, c2, 1.0 - alphaTimesA, 1.0 + alphaOverA, c2, 1.0 - alphaOverA);
+    }
+
+    inline BiquadCoefficients makeLowShelf(double sampleRate, double frequency, double quality, double gainFactor)
+    {
+        const auto A = juce::jmax(0.0, std::sqrt(gainFactor));
+        const auto aminus1 = A - 1.0;
+        const auto aplus1 = A + 1.0;
+        const auto omega = juce::MathConstants<double>::twoPi * juce::jmax(frequency, 2.0) / sampleRate;
+        const auto coso = std::cos(omega);
+        const auto beta = std::sin(omega) * std::sqrt(A) / quality;
+        const auto aminus1TimesCoso = aminus1 * coso;
+
+        return normalise(A * (aplus1 - aminus1TimesCoso + beta),
+                         A * 2.0 * (aminus1 - aplus1 * coso),
+                         A * (aplus1 - aminus1TimesCoso - beta),
+                         aplus1 + aminus1TimesCoso + beta,
+                         -2.0 * (aminus1 + aplus1 * coso),
+                         aplus1 + aminus1TimesCoso - beta);
+    }
+
+    inline BiquadCoefficients makeHighShelf(double sampleRate, double frequency, double quality, double gainFactor)
+    {
+        const auto A = juce::jmax(0.0, std::sqrt(gainFactor));
+        const auto aminus1 = A - 1.0;
+        const auto aplus1 = A + 1.0;
+        const auto omega = juce::MathConstants<double>::twoPi * juce::jmax(frequency, 2.0) / sampleRate;
+        const auto coso = std::cos(omega);
+        const auto beta = std::sin(omega) * std::sqrt(A) / quality;
+        const auto aminus1TimesCoso = aminus1 * coso;
+
+        return normalise(A * (aplus1 + aminus1TimesCoso + beta),
+                         A * -2.0 * (aminus1 + aplus1 * coso),
+                         A * (aplus1 + aminus1TimesCoso - beta),
+                         aplus1 - aminus1TimesCoso + beta,
+                         2.0 * (aminus1 - aplus1 * coso),
+                         aplus1 - aminus1TimesCoso - beta);
+    }
+
+    inline BiquadCoefficients makeNotch(double sampleRate, double frequency, double quality)
+    {
+        const auto n = 1.0 / std::tan(juce::MathConstants<double>::pi * frequency / sampleRate);
+        const auto nSquared = n * n;
+        const auto invQ = 1.0 / quality;
+        const auto c1 = 1.0 / (1.0 + n * invQ + nSquared);
+        const auto b0 = c1 * (1.0 + nSquared);
+        const auto b1 = 2.0 * c1 * (1.0 - nSquared);
+
+        return normalise(b0, b1, b0, 1.0, b1, c1 * (1.0 - n * invQ + nSquared));
+    }
+
+    inline BiquadCoefficients makeHighPass(double sampleRate, double frequency, double quality)
+    {
+        const auto n = std::tan(juce::MathConstants<double>::pi * frequency / sampleRate);
+        const auto nSquared = n * n;
+        const auto invQ = 1.0 / quality;
+        const auto c1 = 1.0 / (1.0 + invQ * n + nSquared);
+
+        return normalise(c1, c1 * -2.0, c1, 1.0, c1 * 2.0 * (nSquared - 1.0), c1 * (1.0 - invQ * n + nSquared));
+    }
+
+    inline BiquadCoefficients makeLowPass(double sampleRate, double frequency, double quality)
+    {
+        const auto n = 1.0 / std::tan(juce::MathConstants<double>::pi * frequency / sampleRate);
+        const auto nSquared = n * n;
+        const auto invQ = 1.0 / quality;
+        const auto c1 = 1.0 / (1.0 + invQ * n + nSquared);
+
+        return normalise(c1, c1 * 2.0, c1, 1.0, c1 * 2.0 * (1.0 - nSquared), c1 * (1.0 - invQ * n + nSquared));
+    }
+
+    // |H| at w = e^-jw, for evaluating many sections at the same frequency
+    inline double getMagnitude(const BiquadCoefficients& c, std::complex<double> w)
+    {
+        const auto numerator = c.b0 + w * (c.b1 + w * c.b2);
+        const auto denominator = 1.0 + w * (c.a1 + w * c.a2);
+
+        return std::abs(numerator / denominator);
+    }
+
+    // |H(e^jw)| at the given frequency, for drawing response curves
+    inline double getMagnitudeForFrequency(const BiquadCoefficients& c, double frequency, double sampleRate)
+    {
+        return getMagnitude(c, std::polar(1.0, -juce::MathConstants<double>::twoPi * frequency / sampleRate));
+    }
+
+    // Samples until the impulse response of the section has decayed by decayFactor, from the
+    // radius of its slowest pole: r^n = decayFactor. Unstable or marginal sections get maxLength.
+    inline double getDecayLength(const BiquadCoefficients& c, double decayFactor, double maxLength)
+    {
+        const auto discriminant = c.a1 * c.a1 - 4.0 * c.a2;
+
+        const auto radius = discriminant < 0.0
+                          ? std::sqrt(c.a2)
+                          : 0.5 * (std::abs(c.a1) + std::sqrt(discriminant));
+
+        if (radius <= 0.0)
+            return 2.0;
+
+        if (radius >= 1.0)
+            return maxLength;
+
+        return juce::jmin(maxLength, 2.0 + std::log(decayFactor) / std::log(radius));
+    }
+
+    // BPR -> Butterworth pole angles, tabulated at compile time. Section s of an order N filter
+    // has its poles at (2s + 1) pi / 2N from the negative real axis, which gives a damping of
+    // 1 / Q = 2 cos(angle). Only the orders the slopes use (2, 4, 6, 8) are in the table.
+
+    namespace Butterworth
+    {
+        constexpr int maxSections = 4;
+
+        // Taylor series, plenty for angles below pi / 2 and usable in a constant expression
+        constexpr double cosine(double x)
+        {
+            double term = 1.0, sum = 1.0;
+
+            for (int n = 1; n < 16; ++n)
+            {
+                term *= -x * x / ((2.0 * n - 1.0) * (2.0 * n));
+                sum += term;
+            }
+
+            return sum;
+        }
+
+        constexpr std::array<std::array<double, maxSections>, maxSections> makeDampingTable()
+        {
+            std::array<std::array<double, maxSections>, maxSections> table {};
+
+            for (int numSections = 1; numSections <= maxSections; ++numSections)
+                for (int s = 0; s < numSections; ++s)
+                    table[(size_t)(numSections - 1)][(size_t)s]
+                        = 2.0 * cosine((2.0 * s + 1.0) * 3.14159265358979323846 / (numSections * 4.0));
+
+            return table;
+        }
+
+        // dampingTable[numSections - 1][section]
+        constexpr auto dampingTable = makeDampingTable();
+
+        static_assert(dampingTable[0][0] > 1.41421356237 && dampingTable[0][0] < 1.41421356238, "2nd order is Q = 1 / sqrt(2)");
+    }
+
+    inline double getButterworthDamping(int order, int section)
+    {
+        jassert(order % 2 == 0 && order >= 2 && order <= Butterworth::maxSections * 2 && section < order / 2);
+        return Butterworth::dampingTable[(size_t)(order / 2 - 1)][(size_t)section];
+    }
+
+    // Q of the given second order section of an even order Butterworth filter
+    inline double getButterworthQuality(int order, int section)
+    {
+        return 1.0 / getButterworthDamping(order, section);
+    }
+
+    // The high and low passes only need one tan() for all their sections, the rest is
+    // arithmetic on the tabulated dampings. Sections past order / 2 are left untouched.
+
+    inline void makeButterworthHighPass(double sampleRate, double frequency, int order,
+                                        std::array<BiquadCoefficients, 4>& sections)
+    {
+        jassert(order % 2 == 0 && order / 2 <= (int)sections.size());
+
+        const auto n = std::tan(juce::MathConstants<double>::pi * frequency / sampleRate);
+        const auto nSquared = n * n;
+
+        for (int i = 0; i < order / 2; ++i)
+        {
+            const auto invQ = getButterworthDamping(order, i);
+            const auto c1 = 1.0 / (1.0 + invQ * n + nSquared);
+
+            sections[(size_t)i] = normalise(c1, c1 * -2.0, c1, 1.0, c1 * 2.0 * (nSquared - 1.0), c1 * (1.0 - invQ * n + nSquared));
+        }
+    }
+
+    inline void makeButterworthLowPass(double sampleRate, double frequency, int order,
+                                       std::array<BiquadCoefficients, 4>& sections)
+    {
+        jassert(order % 2 == 0 && order / 2 <= (int)sections.size());
+
+        const auto n = 1.0 / std::tan(juce::MathConstants<double>::pi * frequency / sampleRate);
+        const auto nSquared = n * n;
+
+        for (int i = 0; i < order / 2; ++i)
+        {
+            const auto invQ = getButterworthDamping(order, i);
+            const auto c1 = 1.0 / (1.0 + invQ * n + nSquared);
+
+            sections[(size_t)i] = normalise(c1, c1 * 2.0, c1, 1.0, c1 * 2.0 * (1.0 - nSquared), c1 * (1.0 - invQ * n + nSquared));
+        }
+    }
+}
@@ -0,0 +1,199 @@
+/*
+  ==============================================================================
+
+    Process wide cache of the Butterworth cut filter designs, shared by every
+    plugin instance through a SharedResourcePointer.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "BiquadCascade.h"
+#include "ParallelCutFilter.h"
+
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <limits>
+
+// BPR -> One cut filter design, the cascade sections plus their parallel form
+struct CutFilterDesign
+{
+    std::array<BiquadCoefficients, 4> sections;
+    ParallelSections parallel;
+};
+
+// BPR -> Fixed size open addressing table, lookups never wait on a writer. Every slot is a
+// small seqlock: a writer claims it by moving its sequence from even to odd, fills it and
+// makes it even again, a reader copies the design and keeps it only if the sequence didn't
+// move meanwhile. The design is held as relaxed atomic words, so a copy that overlaps a
+// store is a discarded read rather than a data race. When the probe window holds no match,
+// the new design replaces the least recently used slot in it (an empty slot counts as the
+// oldest), so frequencies visited once during automation age out instead of filling the
+// table for good.
+//
+// The cutoff is quantised to quantisationStepHz and the design is done at the quantised
+// frequency, so a hit returns exactly what a miss would have computed.
+
+struct CutFilterCache
+{
+    enum class Type
+    {
+        highPass,
+        lowPass
+    };
+
+    static constexpr int capacity = 1024;
+    static constexpr int maxProbes = 16;
+    static constexpr double quantisationStepHz = 0.01;
+
+    static double quantise(double frequency)
+    {
+        return std::round(frequency / quantisationStepHz) * quantisationStepHz;
+    }
+
+    // Calls design(quantisedFrequency, result) on a miss, it has to fill the whole result
+    template <typename DesignFunction>
+    void getOrDesign(Type type, double frequency, int order, double sampleRate,
+                     CutFilterDesign& result, DesignFunction&& design)
+    {
+        const auto key = makeKey(type, frequency, order, sampleRate);
+        const auto now = clock.fetch_add(1, std::memory_order_relaxed) + 1;
+        auto index = (size_t)(hash(key) % (juce::uint64)capacity);
+
+        Slot* oldest = nullptr;
+        auto oldestUse = std::numeric_limits<juce::uint64>::max();
+
+        for (int probe = 0; probe < maxProbes; ++probe, index = (index + 1) % (size_t)capacity)
+        {
+            auto& slot = slots[index];
+            const auto sequence = slot.sequence.load(std::memory_order_acquire);
+            const auto lastUsed = slot.lastUsed.load(std::memory_order_relaxed);
+
+            if ((sequence & 1) == 0 && lastUsed != 0 && slot.key.load(std::memory_order_relaxed) == key)
+            {
+                load(slot, result);
+                std::atomic_thread_fence(std::memory_order_acquire);
+
+                if (slot.sequence.load(std::memory_order_relaxed) == sequence)
+                {
+                    slot.lastUsed.store(now, std::memory_order_relaxed);
+                    hits.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+            }
+
+            if (lastUsed < oldestUse)
+            {
+                oldest = &slot;
+                oldestUse = lastUsed;
+            }
+        }
+
+        misses.fetch_add(1, std::memory_order_relaxed);
+        design(quantise(frequency), result);
+
+        if (oldest != nullptr)
+            store(*oldest, key, result, now);
+    }
+
+    juce::uint64 getNumHits() const { return hits.load(std::memory_order_relaxed); }
+    juce::uint64 getNumMisses() const { return misses.load(std::memory_order_relaxed); }
+    juce::uint64 getNumEvictions() const { return evictions.load(std::memory_order_relaxed); }
+    int getNumEntries() const { return numEntries.load(std::memory_order_relaxed); }
+
+private:
+    // sections (b0 b1 b2 a1 a2 each), then parallel c0, c1, a1, a2, direct and isValid
+    static constexpr size_t numWords = 4 * 5 + 4 * 4 + 2;
+
+    static_assert(std::atomic<double>::is_always_lock_free, "the slots have to stay lock-free");
+
+    struct Slot
+    {
+        // Odd while a writer is filling the slot
+        std::atomic<juce::uint32> sequence { 0 };
+
+        // Value of clock at the last hit or store, 0 for a slot that was never filled
+        std::atomic<juce::uint64> lastUsed { 0 };
+
+        std::atomic<juce::uint64> key { 0 };
+        std::array<std::atomic<double>, numWords> design {};
+    };
+
+    std::array<Slot, capacity> slots;
+
+    std::atomic<juce::uint64> clock { 0 };
+    std::atomic<juce::uint64> hits { 0 }, misses { 0 }, evictions { 0 };
+    std::atomic<int> numEntries { 0 };
+
+    // Gives up when another writer holds the slot, the design just isn't stored this time
+    void store(Slot& slot, juce::uint64 key, const CutFilterDesign& design, juce::uint64 now)
+    {
+        auto sequence = slot.sequence.load(std::memory_order_relaxed);
+
+        if ((sequence & 1) != 0 || ! slot.sequence.compare_exchange_strong(sequence, sequence + 1, std::memory_order_acquire))
+            return;
+
+        std::atomic_thread_fence(std::memory_order_release);
+
+        if (slot.lastUsed.load(std::memory_order_relaxed) == 0)
+            numEntries.fetch_add(1, std::memory_order_relaxed);
+        else
+            evictions.fetch_add(1, std::memory_order_relaxed);
+
+        slot.key.store(key, std::memory_order_relaxed);
+        save(slot, design);
+        slot.lastUsed.store(now, std::memory_order_relaxed);
+        slot.sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    template <typename Design, typename Visitor>
+    static void forEachWord(Design& design, Visitor&& visit)
+    {
+        for (auto& section : design.sections)
+            for (auto* value : { &section.b0, &section.b1, &section.b2, &section.a1, &section.a2 })
+                visit(*value);
+
+        for (auto* values : { &design.parallel.c0, &design.parallel.c1, &design.parallel.a1, &design.parallel.a2 })
+            for (auto& value : *values)
+                visit(value);
+
+        visit(design.parallel.direct);
+    }
+
+    static void load(const Slot& slot, CutFilterDesign& design)
+    {
+        size_t word = 0;
+        forEachWord(design, [&](double& value) { value = slot.design[word++].load(std::memory_order_relaxed); });
+
+        design.parallel.isValid = slot.design[word].load(std::memory_order_relaxed) != 0.0;
+    }
+
+    static void save(Slot& slot, const CutFilterDesign& design)
+    {
+        size_t word = 0;
+        forEachWord(design, [&](double value) { slot.design[word++].store(value, std::memory_order_relaxed); });
+
+        slot.design[word].store(design.parallel.isValid ? 1.0 : 0.0, std::memory_order_relaxed);
+    }
+
+    // quantised frequency | sample rate in Hz | order | type, packed into one word
+    static juce::uint64 makeKey(Type type, double frequency, int order, double sampleRate)
+    {
+        const auto steps = (juce::uint64)std::llround(frequency / quantisationStepHz) & 0xffffffffull;
+        const auto rate = (juce::uint64)std::llround(sampleRate) & 0xffffffull;
+
+        return steps | (rate << 32) | ((juce::uint64)(order & 0x3f) << 56) | ((juce::uint64)(type == Type::lowPass) << 62);
+    }
+
+    static juce::uint64 hash(juce::uint64 key)
+    {
+        key ^= key >> 33;
+        key *= 0xff51afd7ed558ccdull;
+        key ^= key >> 33;
+        return key;
+    }
+};
@@ -0,0 +1,87 @@
+/*
+  ==============================================================================
+
+    Queue between the audio thread and the analyzer threads.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <array>
+#include <atomic>
+#include <utility>
+
+// BPR -> lock-free single producer / single consumer queue of preallocated slots. push and
+// pull swap with the slot rather than copying into it, so each side hands over its element and
+// gets a previously used one back: once the slots are prepared nothing is allocated or copied.
+
+template<typename T, int Capacity = 30>
+struct Fifo
+{
+    void prepare(int numChannels, int numSamples)
+    {
+        
+        for (auto& buffer : buffers)
+        {
+            buffer.setSize(numChannels, numSamples, false, true, true);
+            buffer.clear();
+        }
+    }
+
+    void prepare(size_t numElements)
+    {
+        
+        for (auto& buffer : buffers)
+        {
+            buffer.clear();
+            buffer.resize(numElements, 0);
+        }
+    }
+
+    // t goes into the queue and comes back holding the slot's previous element.
+    // Fails, leaving t alone, when the queue is full.
+    bool push(T& t)
+    {
+        auto write = fifo.write(1);
+        if (write.blockSize1 > 0)
+        {
+            std::swap(buffers[write.startIndex1], t);
+            return true;
+        }
+
+        overflows.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    // t takes the oldest element, its own contents go back into the slot for reuse.
+    // Fails, leaving t alone, when the queue is empty.
+    bool pull(T& t)
+    {
+        auto read = fifo.read(1);
+        if (read.blockSize1 > 0)
+        {
+            std::swap(buffers[read.startIndex1], t);
+            return true;
+        }
+
+        underflows.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    int getNumAvailableForReading() const
+    {
+        return fifo.getNumReady();
+    }
+
+    // Pushes dropped because the consumer fell behind, and pulls that found nothing
+    int getNumOverflows() const { return overflows.load(std::memory_order_relaxed); }
+    int getNumUnderflows() const { return underflows.load(std::memory_order_relaxed); }
+private:
+    // AbstractFifo keeps one slot free to tell full from empty
+    std::array<T, Capacity + 1> buffers;
+    juce::AbstractFifo fifo{ Capacity + 1 };
+    std::atomic<int> overflows{ 0 }, underflows{ 0 };
+};
@@ -0,0 +1,626 @@
+/*
+  ==============================================================================
+
+    Linear phase mode: a symmetric FIR with the magnitude response of the
+    whole chain, run with partitioned overlap-save convolution, either with
+    uniform partitions or with a small head and a large, time distributed tail.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// BPR -> The FIR, cut into partitionSize long pieces and stored as the spectra of those
+// pieces zero padded to 2 * partitionSize. Every spectrum is partitionSize + 1 complex
+// values, interleaved (re, im) the way juce::dsp::FFT lays out real transforms.
+// A non uniform kernel only has its head in partitionSize pieces, the rest of the FIR
+// follows in tailPartitionSize pieces. Every design gets a newer version, so a convolver can
+// tell a kernel it was handed late from the one it already has.
+
+struct LinearPhaseKernel
+{
+    int partitionSize = 0, numPartitions = 0;
+    int tailPartitionSize = 0, numTailPartitions = 0;
+    std::vector<float> spectra, tailSpectra;
+    juce::uint32 version = 0;
+
+    bool isEmpty() const { return numPartitions == 0; }
+
+    bool hasSameLayout(const LinearPhaseKernel& other) const
+    {
+        return partitionSize == other.partitionSize && numPartitions == other.numPartitions
+            && tailPartitionSize == other.tailPartitionSize && numTailPartitions == other.numTailPartitions;
+    }
+};
+
+// BPR -> Frequency sampling design, done on the design thread. The magnitudes (linear gain at
+// bin k = k * sampleRate / firLength, zero phase) go through one inverse FFT, the impulse is
+// rotated by firLength / 2 so it becomes causal and symmetric, then windowed with a Hann
+// window to tame the time aliasing of the sampled response. The result delays everything by
+// firLength / 2 samples.
+
+struct LinearPhaseDesigner
+{
+    // Long enough for the 20 Hz cuts at ~6 Hz resolution, and a power of two for the FFT
+    static int getFirLength(double sampleRate)
+    {
+        return juce::nextPowerOfTwo((int)std::ceil(sampleRate * 0.17));
+    }
+
+    // How much of the FIR the head partitions cover. The tail output of a frame is only needed
+    // one tail partition after the frame is complete, which leaves that long to compute it.
+    static int getHeadLength(int firLength, int partitionSize, int tailPartitionSize)
+    {
+        return tailPartitionSize > 0 ? tailPartitionSize * 2 - partitionSize : firLength;
+    }
+
+    // The partition counts design() will produce, with empty spectra
+    static LinearPhaseKernel makeLayout(int firLength, int partitionSize, int tailPartitionSize)
+    {
+        const auto headLength = getHeadLength(firLength, partitionSize, tailPartitionSize);
+
+        LinearPhaseKernel layout;
+        layout.partitionSize = partitionSize;
+        layout.numPartitions = (headLength + partitionSize - 1) / partitionSize;
+        layout.tailPartitionSize = tailPartitionSize;
+        layout.numTailPartitions = tailPartitionSize > 0 ? (firLength - headLength + tailPartitionSize - 1) / tailPartitionSize : 0;
+
+        return layout;
+    }
+
+    // tailPartitionSize == 0 designs uniform kernels
+    void prepare(int firLengthToUse, int partitionSizeToUse, int tailPartitionSizeToUse = 0)
+    {
+        jassert(juce::isPowerOfTwo(firLengthToUse) && juce::isPowerOfTwo(partitionSizeToUse));
+        jassert(partitionSizeToUse <= firLengthToUse);
+        jassert(tailPartitionSizeToUse == 0
+                || (juce::isPowerOfTwo(tailPartitionSizeToUse) && tailPartitionSizeToUse >= partitionSizeToUse * 2
+                    && getHeadLength(firLengthToUse, partitionSizeToUse, tailPartitionSizeToUse) < firLengthToUse));
+
+        firLength = firLengthToUse;
+        partitionSize = partitionSizeToUse;
+        tailPartitionSize = tailPartitionSizeToUse;
+
+        firFFT = std::make_unique<juce::dsp::FFT>(getOrder(firLength));
+        partitionFFT = std::make_unique<juce::dsp::FFT>(getOrder(partitionSize * 2));
+        tailPartitionFFT.reset();
+
+        if (tailPartitionSize > 0)
+            tailPartitionFFT = std::make_unique<juce::dsp::FFT>(getOrder(tailPartitionSize * 2));
+
+        magnitudes.assign((size_t)(firLength / 2 + 1), 1.0);
+        impulse.assign((size_t)(firLength * 2), 0.f);
+        partition.assign((size_t)(juce::jmax(partitionSize, tailPartitionSize) * 4), 0.f);
+
+        window.resize((size_t)firLength);
+
+        for (int n = 0; n < firLength; ++n)
+            window[(size_t)n] = 0.5f - 0.5f * std::cos(juce::MathConstants<float>::twoPi * (float)n / (float)firLength);
+    }
+
+    int getFirLength() const { return firLength; }
+    int getPartitionSize() const { return partitionSize; }
+    int getTailPartitionSize() const { return tailPartitionSize; }
+
+    // One linear gain per bin, firLength / 2 + 1 of them, filled in before design()
+    std::vector<double>& getMagnitudes() { return magnitudes; }
+
+    void design(LinearPhaseKernel& kernel)
+    {
+        jassert(firFFT != nullptr);
+
+        std::fill(impulse.begin(), impulse.end(), 0.f);
+
+        for (size_t k = 0; k < magnitudes.size(); ++k)
+            impulse[k * 2] = (float)magnitudes[k];
+
+        firFFT->performRealOnlyInverseTransform(impulse.data());
+
+        // The zero phase impulse is centred on sample 0, move the centre to firLength / 2
+        std::rotate(impulse.begin(), impulse.begin() + firLength / 2, impulse.begin() + firLength);
+
+        for (int n = 0; n < firLength; ++n)
+            impulse[(size_t)n] *= window[(size_t)n];
+
+        const auto headLength = getHeadLength(firLength, partitionSize, tailPartitionSize);
+
+        kernel.version = ++designedVersion;
+        kernel.partitionSize = partitionSize;
+        kernel.numPartitions = split(0, headLength, partitionSize, *partitionFFT, kernel.spectra);
+
+        kernel.tailPartitionSize = tailPartitionSize;
+        kernel.numTailPartitions = tailPartitionSize > 0
+                                 ? split(headLength, firLength - headLength, tailPartitionSize, *tailPartitionFFT, kernel.tailSpectra)
+                                 : 0;
+    }
+
+    static int getOrder(int size)
+    {
+        int order = 0;
+
+        while ((1 << order) < size)
+            ++order;
+
+        return order;
+    }
+
+private:
+    int firLength = 0, partitionSize = 0, tailPartitionSize = 0;
+
+    // Not touched by prepare(), versions keep counting up across layouts
+    juce::uint32 designedVersion = 0;
+
+    std::unique_ptr<juce::dsp::FFT> firFFT, partitionFFT, tailPartitionFFT;
+
+    std::vector<double> magnitudes;
+    std::vector<float> impulse, partition, window;
+
+    // Spectra of the size long pieces of impulse[start, start + length), the last one zero padded
+    int split(int start, int length, int size, const juce::dsp::FFT& fft, std::vector<float>& spectra)
+    {
+        const auto numPieces = (length + size - 1) / size;
+        const auto numFloats = (size_t)(size + 1) * 2;
+
+        spectra.resize(numFloats * (size_t)numPieces);
+
+        for (int p = 0; p < numPieces; ++p)
+        {
+            const auto first = start + p * size;
+            const auto num = juce::jmin(size, start + length - first);
+
+            std::fill(partition.begin(), partition.end(), 0.f);
+            std::copy_n(impulse.begin() + first, num, partition.begin());
+
+            fft.performRealOnlyForwardTransform(partition.data(), true);
+
+            std::copy_n(partition.begin(), numFloats, spectra.begin() + (std::ptrdiff_t)(numFloats * (size_t)p));
+        }
+
+        return numPieces;
+    }
+};
+
+// BPR -> One partition size worth of overlap-save state. Input is gathered partitionSize samples
+// at a time; every full partition is transformed once (a 2 * partitionSize FFT of the last two
+// partitions of input) and pushed into a frequency domain delay line. The output spectrum is the
+// sum of the delay line times the kernel partitions, and one inverse FFT gives the next
+// partitionSize output samples (the second half, the first half is the circular wrap around
+// that overlap-save throws away). The accumulation can be done a few partitions at a time.
+
+struct OverlapSaveStage
+{
+    static constexpr int numAccumulators = 2;
+
+    void prepare(int numChannels, int partitionSizeToUse, int numPartitionsToUse)
+    {
+        partitionSize = partitionSizeToUse;
+        numPartitions = juce::jmax(1, numPartitionsToUse);
+
+        fft = std::make_unique<juce::dsp::FFT>(LinearPhaseDesigner::getOrder(partitionSize * 2));
+
+        channels.resize((size_t)numChannels);
+
+        for (auto& channel : channels)
+        {
+            channel.input.assign((size_t)partitionSize * 2, 0.f);
+            channel.delayLine.assign((size_t)getSpectrumSize() * (size_t)numPartitions, 0.f);
+
+            for (auto& accumulator : channel.accumulators)
+                accumulator.assign((size_t)partitionSize * 4, 0.f);
+        }
+
+        reset();
+    }
+
+    void reset()
+    {
+        for (auto& channel : channels)
+        {
+            std::fill(channel.input.begin(), channel.input.end(), 0.f);
+            std::fill(channel.delayLine.begin(), channel.delayLine.end(), 0.f);
+
+            for (auto& accumulator : channel.accumulators)
+                std::fill(accumulator.begin(), accumulator.end(), 0.f);
+        }
+
+        newest = 0;
+    }
+
+    int getSpectrumSize() const { return (partitionSize + 1) * 2; }
+
+    // Where the caller writes the partitionSize samples of the frame being gathered
+    float* getInput(int channel) { return channels[(size_t)channel].input.data() + partitionSize; }
+
+    // Makes room in the delay line, every channel has to push a frame after this
+    void advance() { newest = (newest + 1) % numPartitions; }
+
+    void pushFrame(int channel)
+    {
+        auto& state = channels[(size_t)channel];
+        auto& scratch = state.accumulators[0];
+
+        std::copy(state.input.begin(), state.input.end(), scratch.begin());
+        std::fill(scratch.begin() + partitionSize * 2, scratch.end(), 0.f);
+
+        fft->performRealOnlyForwardTransform(scratch.data(), true);
+
+        std::copy_n(scratch.begin(), getSpectrumSize(), state.delayLine.begin() + newest * getSpectrumSize());
+
+        // The newer half of the input is the older half of the next frame
+        std::copy_n(state.input.begin() + partitionSize, partitionSize, state.input.begin());
+    }
+
+    void clearAccumulator(int channel, int index)
+    {
+        auto& accumulator = channels[(size_t)channel].accumulators[(size_t)index];
+        std::fill(accumulator.begin(), accumulator.end(), 0.f);
+    }
+
+    // Adds kernel partitions [first, end) times the input spectra from that many frames ago
+    void accumulate(int channel, int index, const float* spectra, int first, int end)
+    {
+        const auto& state = channels[(size_t)channel];
+        const auto spectrumSize = getSpectrumSize();
+
+        auto* acc = channels[(size_t)channel].accumulators[(size_t)index].data();
+
+        for (int p = first; p < end; ++p)
+        {
+            const auto slot = (newest - p + numPartitions) % numPartitions;
+            const auto* x = state.delayLine.data() + slot * spectrumSize;
+            const auto* h = spectra + p * spectrumSize;
+
+            for (int k = 0; k < spectrumSize; k += 2)
+            {
+                acc[k]     += x[k] * h[k]     - x[k + 1] * h[k + 1];
+                acc[k + 1] += x[k] * h[k + 1] + x[k + 1] * h[k];
+            }
+        }
+    }
+
+    // Back to the time domain, this uses up the accumulator
+    void inverse(int channel, int index, float* destination)
+    {
+        auto& accumulator = channels[(size_t)channel].accumulators[(size_t)index];
+
+        fft->performRealOnlyInverseTransform(accumulator.data());
+
+        std::copy_n(accumulator.begin() + partitionSize, partitionSize, destination);
+    }
+
+private:
+    struct Channel
+    {
+        std::vector<float> input, delayLine;
+        std::array<std::vector<float>, numAccumulators> accumulators;
+    };
+
+    int partitionSize = 0, numPartitions = 1, newest = 0;
+
+    std::unique_ptr<juce::dsp::FFT> fft;
+    std::vector<Channel> channels;
+};
+
+// BPR -> Partitioned convolution of a LinearPhaseKernel, latency one (head) partition.
+//
+// Uniform kernels run on one stage: every partitionSize samples costs two small FFTs plus a
+// multiply-add per bin and partition.
+//
+// Non uniform kernels add a tail stage with tailPartitionSize = R * partitionSize. The head
+// covers the first 2 * tailPartitionSize - partitionSize taps, so the tail's contribution of a
+// tail frame is only due one tail partition after that frame is complete. Its work is spread
+// over the R head partitions in between: the forward FFT when the frame completes, then a share
+// of the multiply-adds every head partition, the inverse FFT last. No callback pays for a
+// whole large partition, and the latency stays at the head partition.
+//
+// A new kernel never replaces the current one in the middle of a (tail) frame. The tail frame
+// that starts next is computed with both kernels, and when its output is due, head and tail
+// crossfade over the same tail partition worth of samples. Both kernels read the same delay
+// lines, so this costs one extra multiply-add pass, once. Without a tail the crossfade is one
+// head partition.
+
+struct PartitionedConvolver
+{
+    // The layout comes from LinearPhaseDesigner::makeLayout, only its partition counts are used
+    void prepare(int numChannels, const LinearPhaseKernel& kernelLayout)
+    {
+        layout = kernelLayout;
+        layout.spectra.clear();
+        layout.tailSpectra.clear();
+
+        partitionSize = layout.partitionSize;
+        tailPartitionSize = layout.tailPartitionSize;
+        hasTail = tailPartitionSize > 0;
+        ticksPerFrame = hasTail ? tailPartitionSize / partitionSize : 1;
+        numTailUnits = hasTail ? layout.numTailPartitions + 1 : 0;
+
+        head.prepare(numChannels, partitionSize, layout.numPartitions);
+
+        if (hasTail)
+            tail.prepare(numChannels, tailPartitionSize, layout.numTailPartitions);
+
+        outputs.resize((size_t)numChannels);
+
+        for (auto& output : outputs)
+        {
+            output.head.assign((size_t)partitionSize, 0.f);
+            output.tailReady.assign((size_t)tailPartitionSize, 0.f);
+            output.tailPending.assign((size_t)tailPartitionSize, 0.f);
+        }
+
+        fadeBuffer.assign((size_t)juce::jmax(partitionSize, tailPartitionSize), 0.f);
+
+        // setKernel copies into these on the audio thread, so they never have to grow there
+        for (auto* kernel : { &current, &next })
+        {
+            *kernel = {};
+            kernel->spectra.reserve((size_t)((partitionSize + 1) * 2 * layout.numPartitions));
+            kernel->tailSpectra.reserve((size_t)((tailPartitionSize + 1) * 2 * layout.numTailPartitions));
+        }
+
+        fade = Fade::none;
+        latestVersion = 0;
+        reset();
+    }
+
+    void reset()
+    {
+        head.reset();
+
+        if (hasTail)
+            tail.reset();
+
+        for (auto& output : outputs)
+        {
+            std::fill(output.head.begin(), output.head.end(), 0.f);
+            std::fill(output.tailReady.begin(), output.tailReady.end(), 0.f);
+            std::fill(output.tailPending.begin(), output.tailPending.end(), 0.f);
+        }
+
+        inputPosition = 0;
+        tick = 0;
+        tailUnitsDone = numTailUnits;
+    }
+
+    // A crossfade in progress has to finish first, the caller keeps the newer kernel until then
+    bool canAcceptKernel() const { return fade == Fade::none; }
+
+    // Kernels with another partition layout (left over from before a re-prepare) are ignored,
+    // and so is one that isn't newer than the last kernel taken
+    void setKernel(const LinearPhaseKernel& kernel)
+    {
+        if (! kernel.hasSameLayout(layout) || ! canAcceptKernel() || kernel.version <= latestVersion)
+            return;
+
+        latestVersion = kernel.version;
+
+        if (current.isEmpty())
+        {
+            current = kernel;
+            return;
+        }
+
+        next = kernel;
+        fade = Fade::scheduled;
+    }
+
+    int getLatencyInSamples() const { return partitionSize; }
+
+    // The FIR itself always runs in float, a double block is converted on the way in and out
+    template<typename SampleType>
+    void process(const juce::dsp::AudioBlock<SampleType>& block)
+    {
+        const auto numToProcess = juce::jmin((int)block.getNumChannels(), (int)outputs.size());
+        const auto numSamples = (int)block.getNumSamples();
+
+        for (int start = 0; start < numSamples;)
+        {
+            const auto num = juce::jmin(partitionSize - inputPosition, numSamples - start);
+            const auto tailPosition = tick * partitionSize + inputPosition;
+
+            for (int ch = 0; ch < numToProcess; ++ch)
+            {
+                auto& output = outputs[(size_t)ch];
+                auto* data = block.getChannelPointer((size_t)ch) + start;
+
+                copy(data, head.getInput(ch) + inputPosition, num);
+
+                if (hasTail)
+                    copy(data, tail.getInput(ch) + tailPosition, num);
+
+                copy(output.head.data() + inputPosition, data, num);
+
+                if (hasTail)
+                {
+                    const auto* tailOutput = output.tailReady.data() + tailPosition;
+
+                    for (int i = 0; i < num; ++i)
+                        data[i] += (SampleType)tailOutput[i];
+                }
+            }
+
+            inputPosition += num;
+            start += num;
+
+            if (inputPosition == partitionSize)
+            {
+                processPartition(numToProcess);
+                inputPosition = 0;
+            }
+        }
+    }
+
+private:
+    enum class Fade
+    {
+        none,
+        scheduled,      // waiting for the next frame to start
+        tailFading,     // the tail frame in the works is computed with both kernels
+        headFading      // the outputs of both kernels are being crossfaded
+    };
+
+    struct ChannelOutputs
+    {
+        std::vector<float> head, tailReady, tailPending;
+    };
+
+    OverlapSaveStage head, tail;
+    LinearPhaseKernel layout, current, next;
+    Fade fade = Fade::none;
+    juce::uint32 latestVersion = 0;
+
+    bool hasTail = false;
+    int partitionSize = 0, tailPartitionSize = 0, ticksPerFrame = 1, numTailUnits = 0;
+    int inputPosition = 0, tick = 0, tailUnitsDone = 0;
+
+    std::vector<ChannelOutputs> outputs;
+    std::vector<float> fadeBuffer;
+
+    // tick is the head partition about to be played, counted from the start of the tail frame
+    void processPartition(int numToProcess)
+    {
+        tick = (tick + 1) % ticksPerFrame;
+
+        if (tick == 0)
+            startFrame(numToProcess);
+
+        processHead(numToProcess);
+
+        if (hasTail)
+            runTailUnits(numToProcess, (numTailUnits * (tick + 1) + ticksPerFrame - 1) / ticksPerFrame);
+    }
+
+    void startFrame(int numToProcess)
+    {
+        if (hasTail)
+        {
+            // Normally done already, the last tick of a frame finishes the job
+            runTailUnits(numToProcess, numTailUnits);
+
+            for (auto& output : outputs)
+                std::swap(output.tailReady, output.tailPending);
+        }
+
+        switch (fade)
+        {
+            case Fade::scheduled:  fade = hasTail ? Fade::tailFading : Fade::headFading; break;
+            case Fade::tailFading: fade = Fade::headFading; break;
+            case Fade::headFading: std::swap(current, next); fade = Fade::none; break;
+            case Fade::none:
+            default: break;
+        }
+
+        if (! hasTail)
+            return;
+
+        tail.advance();
+
+        for (int ch = 0; ch < numToProcess; ++ch)
+        {
+            tail.pushFrame(ch);
+
+            for (int i = 0; i < OverlapSaveStage::numAccumulators; ++i)
+                tail.clearAccumulator(ch, i);
+        }
+
+        tailUnitsDone = 0;
+    }
+
+    void processHead(int numToProcess)
+    {
+        head.advance();
+
+        for (int ch = 0; ch < numToProcess; ++ch)
+        {
+            auto& output = outputs[(size_t)ch].head;
+
+            head.pushFrame(ch);
+
+            if (current.isEmpty())
+            {
+                std::fill(output.begin(), output.end(), 0.f);
+                continue;
+            }
+
+            head.clearAccumulator(ch, 0);
+            head.accumulate(ch, 0, current.spectra.data(), 0, current.numPartitions);
+            head.inverse(ch, 0, output.data());
+
+            if (fade != Fade::headFading)
+                continue;
+
+            head.clearAccumulator(ch, 1);
+            head.accumulate(ch, 1, next.spectra.data(), 0, next.numPartitions);
+            head.inverse(ch, 1, fadeBuffer.data());
+
+            crossfade(output.data(), fadeBuffer.data(), tick * partitionSize, partitionSize);
+        }
+    }
+
+    // Unit u < numTailPartitions accumulates tail partition u, the last unit is the inverse FFT
+    void runTailUnits(int numToProcess, int target)
+    {
+        // During the head crossfade the tail already works on the new kernel's frames
+        const auto& kernel = fade == Fade::headFading ? next : current;
+        const auto bothKernels = fade == Fade::tailFading;
+
+        for (; tailUnitsDone < target; ++tailUnitsDone)
+        {
+            const auto unit = tailUnitsDone;
+
+            for (int ch = 0; ch < numToProcess; ++ch)
+            {
+                if (unit < numTailUnits - 1)
+                {
+                    if (kernel.isEmpty())
+                        continue;
+
+                    tail.accumulate(ch, 0, kernel.tailSpectra.data(), unit, unit + 1);
+
+                    if (bothKernels)
+                        tail.accumulate(ch, 1, next.tailSpectra.data(), unit, unit + 1);
+
+                    continue;
+                }
+
+                auto& pending = outputs[(size_t)ch].tailPending;
+
+                tail.inverse(ch, 0, pending.data());
+
+                if (bothKernels)
+                {
+                    tail.inverse(ch, 1, fadeBuffer.data());
+                    crossfade(pending.data(), fadeBuffer.data(), 0, tailPartitionSize);
+                }
+            }
+        }
+    }
+
+    template<typename Source, typename Destination>
+    static void copy(const Source* source, Destination* destination, int num)
+    {
+        for (int i = 0; i < num; ++i)
+            destination[i] = (Destination)source[i];
+    }
+
+    // Moves destination towards source, position counts from the start of the fade
+    void crossfade(float* destination, const float* source, int position, int num) const
+    {
+        const auto fadeLength = (float)(ticksPerFrame * partitionSize);
+
+        for (int i = 0; i < num; ++i)
+        {
+            const auto gain = (float)(position + i + 1) / fadeLength;
+            destination[i] += gain * (source[i] - destination[i]);
+        }
+    }
+};
@@ -0,0 +1,319 @@
+/*
+  ==============================================================================
+
+    Parallel form (sum of second order sections) realisation of the
+    Butterworth cut filters, for running their sections side by side.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "BiquadCascade.h"
+
+#include <array>
+#include <complex>
+#include <vector>
+
+// BPR -> H(z) = direct + sum of (c0 + c1 z^-1) / (1 + a1 z^-1 + a2 z^-2), one term per section.
+// Unused terms keep zero coefficients so they add nothing. Kept in double like
+// BiquadCoefficients, the engines round it to their sample type.
+
+struct ParallelSections
+{
+    std::array<double, 4> c0 {}, c1 {}, a1 {}, a2 {};
+    double direct { 1.0 };
+    bool isValid { false };
+
+    // What a float engine runs
+    ParallelSections roundedToFloat() const
+    {
+        auto rounded = *this;
+
+        for (auto* values : { &rounded.c0, &rounded.c1, &rounded.a1, &rounded.a2 })
+            for (auto& v : *values)
+                v = (double)(float)v;
+
+        rounded.direct = (double)(float)direct;
+        return rounded;
+    }
+};
+
+namespace ParallelForm
+{
+    using Complex = std::complex<double>;
+
+    inline Complex evaluate(double c0, double c1, double c2, Complex w)
+    {
+        return c0 + w * (c1 + w * c2);
+    }
+
+    inline Complex getResponse(const ParallelSections& sections, int numSections, Complex w)
+    {
+        Complex h = sections.direct;
+
+        for (int k = 0; k < numSections; ++k)
+            h += evaluate(sections.c0[(size_t)k], sections.c1[(size_t)k], 0.0, w)
+               / evaluate(1.0, sections.a1[(size_t)k], sections.a2[(size_t)k], w);
+
+        return h;
+    }
+
+    inline Complex getResponse(const std::array<BiquadCoefficients, 4>& cascade, int numSections, Complex w)
+    {
+        Complex h = 1.0;
+
+        for (int k = 0; k < numSections; ++k)
+        {
+            const auto& c = cascade[(size_t)k];
+            h *= evaluate(c.b0, c.b1, c.b2, w) / evaluate(1.0, c.a1, c.a2, w);
+        }
+
+        return h;
+    }
+}
+
+// BPR -> Partial fraction expansion of a cascade of second order sections.
+// Every section contributes one complex conjugate pole pair p, p* and the residue r of the
+// whole cascade at p gives the term r / (1 - p z^-1) + conj, i.e.
+// (2 Re(r) - 2 Re(r p*) z^-1) / (1 - 2 Re(p) z^-1 + |p|^2 z^-2).
+// The result rounded to float, the least precise form it runs in, is checked against the
+// cascade, and left invalid when it drifts more than maxErrorInDecibels anywhere above -60 dB
+// between 20 Hz and 20 kHz, or when a section has real poles.
+
+inline ParallelSections makeParallelSections(const std::array<BiquadCoefficients, 4>& cascade,
+                                             int numSections,
+                                             double sampleRate,
+                                             double maxErrorInDecibels = 0.1)
+{
+    using namespace ParallelForm;
+
+    ParallelSections result;
+
+    std::array<Complex, 4> poles;
+    double direct = 1.0;
+
+    for (int k = 0; k < numSections; ++k)
+    {
+        const auto& c = cascade[(size_t)k];
+        const auto discriminant = (double)c.a1 * c.a1 - 4.0 * c.a2;
+
+        if (discriminant >= 0.0 || c.a2 == 0.0)
+            return result;
+
+        poles[(size_t)k] = { -0.5 * c.a1, 0.5 * std::sqrt(-discriminant) };
+        direct *= (double)c.b2 / c.a2;
+    }
+
+    for (int k = 0; k < numSections; ++k)
+    {
+        const auto p = poles[(size_t)k];
+        const auto w = 1.0 / p;
+
+        // Residue of the full cascade at p, with this section's own (1 - p w) factor removed
+        auto residue = 1.0 / (1.0 - std::conj(p) * w);
+
+        for (int j = 0; j < numSections; ++j)
+        {
+            const auto& c = cascade[(size_t)j];
+            residue *= evaluate(c.b0, c.b1, c.b2, w);
+
+            if (j != k)
+                residue /= evaluate(1.0, c.a1, c.a2, w);
+        }
+
+        result.c0[(size_t)k] = 2.0 * residue.real();
+        result.c1[(size_t)k] = -2.0 * (residue * std::conj(p)).real();
+        result.a1[(size_t)k] = cascade[(size_t)k].a1;
+        result.a2[(size_t)k] = cascade[(size_t)k].a2;
+    }
+
+    result.direct = direct;
+
+    const auto rounded = result.roundedToFloat();
+
+    // BPR -> The error of the expansion is close to constant in absolute terms, so in dB it peaks
+    // wherever the response is lowest. Comparing against the largest absolute error that stays
+    // within maxErrorInDecibels at -60 dB keeps the check from depending on where the grid
+    // happens to land in the transition band (1.5x steps let expansions 1 dB off through).
+    const auto maxRatio = juce::Decibels::decibelsToGain(maxErrorInDecibels) - 1.0;
+    const auto step = std::pow(2.0, 1.0 / 24.0);
+
+    for (double freq = 20.0; freq <= 20000.0 && freq < sampleRate * 0.5; freq *= step)
+    {
+        const auto w = std::polar(1.0, -juce::MathConstants<double>::twoPi * freq / sampleRate);
+
+        const auto reference = std::abs(getResponse(cascade, numSections, w));
+        const auto parallel = std::abs(getResponse(rounded, numSections, w));
+
+        if (std::abs(parallel - reference) > juce::jmax(reference, 1.0e-3) * maxRatio)
+            return result;
+    }
+
+    result.isValid = true;
+    return result;
+}
+
+// BPR -> Runs up to four parallel sections in the lanes of SIMDRegisters, so the sections of a
+// cut filter no longer wait on each other. Section k sits in lane k % Register::size() of
+// register k / Register::size(): one register for floats, two for doubles. The lanes are
+// summed per sample, and every channel keeps its own state.
+//
+// Switching the filter on or off while it runs fades between the input and the filtered
+// signal over crossfadeSeconds, y = x + wet (H(x) - x). The sections keep running with their
+// state until the fade out is over, and a fade in starts them from silence.
+
+template<typename SampleType>
+struct BasicParallelCutFilter
+{
+    using Register = juce::dsp::SIMDRegister<SampleType>;
+
+    static constexpr size_t maxSections = 4;
+    static constexpr size_t numRegisters = (maxSections + Register::size() - 1) / Register::size();
+
+    using Registers = std::array<Register, numRegisters>;
+
+    static constexpr double crossfadeSeconds = 0.005;
+
+    void prepare(int numChannels, double sampleRate)
+    {
+        s1.resize((size_t)numChannels);
+        s2.resize((size_t)numChannels);
+        fadeStep = (SampleType)1 / (SampleType)juce::jmax(1, juce::roundToInt(sampleRate * crossfadeSeconds));
+        reset();
+    }
+
+    // Back to silence, and the next setActive() takes effect without a fade
+    void reset()
+    {
+        clearState();
+        wet = active ? (SampleType)1 : (SampleType)0;
+        running = false;
+    }
+
+    // Switched off and back to silence at once, for state the signal hasn't gone through in
+    // a while. Unlike after reset() the next setActive(true) fades in.
+    void deactivate()
+    {
+        clearState();
+        active = false;
+        wet = 0;
+        running = true;
+    }
+
+    void setSections(const ParallelSections& sections)
+    {
+        for (size_t r = 0; r < numRegisters; ++r)
+            c0[r] = c1[r] = a1[r] = negA2[r] = Register::expand(0);
+
+        for (size_t k = 0; k < maxSections; ++k)
+        {
+            const auto r = k / Register::size(), lane = k % Register::size();
+
+            c0[r].set(lane, (SampleType)sections.c0[k]);
+            c1[r].set(lane, (SampleType)sections.c1[k]);
+            a1[r].set(lane, (SampleType)sections.a1[k]);
+            negA2[r].set(lane, (SampleType)-sections.a2[k]);
+        }
+
+        direct = (SampleType)sections.direct;
+    }
+
+    void setActive(bool shouldBeActive)
+    {
+        // Coming back in the middle of a fade out, the sections still have their state
+        if (shouldBeActive && wet == (SampleType)0)
+            clearState();
+
+        active = shouldBeActive;
+
+        if (! running)
+            wet = active ? (SampleType)1 : (SampleType)0;
+    }
+
+    // Switched on, or switched off but still fading out
+    bool isActive() const { return active || wet > (SampleType)0; }
+
+    void process(const juce::dsp::AudioBlock<SampleType>& block)
+    {
+        running = true;
+
+        if (! isActive())
+            return;
+
+        const auto numToProcess = juce::jmin((int)block.getNumChannels(), (int)s1.size());
+        const auto numSamples = (int)block.getNumSamples();
+        const auto target = active ? (SampleType)1 : (SampleType)0;
+
+        if (wet != target)
+            processChannels<true>(block, numToProcess, numSamples, target);
+        else
+            processChannels<false>(block, numToProcess, numSamples, target);
+    }
+
+private:
+    Registers c0, c1, a1, negA2;
+    SampleType direct = 1;
+
+    std::vector<Registers> s1, s2;
+    bool active = false, running = false;
+
+    // Share of the filtered signal in the output, moves by fadeStep per sample towards active
+    SampleType wet = 0, fadeStep = 1;
+
+    void clearState()
+    {
+        for (size_t ch = 0; ch < s1.size(); ++ch)
+        {
+            s1[ch].fill(Register::expand(0));
+            s2[ch].fill(Register::expand(0));
+        }
+    }
+
+    SampleType getWetAfter(int numSamples, SampleType target) const
+    {
+        const auto distance = fadeStep * (SampleType)numSamples;
+        return target > wet ? juce::jmin(target, wet + distance) : juce::jmax(target, wet - distance);
+    }
+
+    template<bool fading>
+    void processChannels(const juce::dsp::AudioBlock<SampleType>& block, int numToProcess, int numSamples, SampleType target)
+    {
+        for (int ch = 0; ch < numToProcess; ++ch)
+        {
+            auto* data = block.getChannelPointer((size_t)ch);
+            auto z1 = s1[(size_t)ch];
+            auto z2 = s2[(size_t)ch];
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const auto input = data[i];
+                const auto x = Register::expand(input);
+                auto output = direct * input;
+
+                for (size_t r = 0; r < numRegisters; ++r)
+                {
+                    const auto y = (x * c0[r]) + z1[r];
+                    z1[r] = (x * c1[r]) - (y * a1[r]) + z2[r];
+                    z2[r] = y * negA2[r];
+                    output += y.sum();
+                }
+
+                if constexpr (fading)
+                    data[i] = input + getWetAfter(i + 1, target) * (output - input);
+                else
+                    data[i] = output;
+            }
+
+            s1[(size_t)ch] = z1;
+            s2[(size_t)ch] = z2;
+        }
+
+        if constexpr (fading)
+            wet = getWetAfter(numSamples, target);
+    }
+};
+
+using ParallelCutFilter = BasicParallelCutFilter<float>;
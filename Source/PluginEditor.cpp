@@ -144,8 +144,41 @@ juce::String RotarySliderWithLabels::getDisplayString() const
 
 }
 
+BandControls::BandControls(juce::AudioProcessorValueTreeState& apvts, int band) :
+    freqSlider(*apvts.getParameter("Band " + juce::String(band) + " Freq"), "Hz"),
+    gainSlider(*apvts.getParameter("Band " + juce::String(band) + " Gain"), "dB"),
+    qualitySlider(*apvts.getParameter("Band " + juce::String(band) + " Quality"), ""),
+    freqSliderAttachement(apvts, "Band " + juce::String(band) + " Freq", freqSlider),
+    gainSliderAttachement(apvts, "Band " + juce::String(band) + " Gain", gainSlider),
+    qualitySliderAttachement(apvts, "Band " + juce::String(band) + " Quality", qualitySlider)
+{
+    const auto typeID = "Band " + juce::String(band) + " Type";
+
+    if (auto* typeParam = dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter(typeID)))
+        typeBox.addItemList(typeParam->choices, 1);
+
+    typeBoxAttachement = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(apvts, typeID, typeBox);
+}
+
+SideControls::SideControls(juce::AudioProcessorValueTreeState& apvts) :
+    lowCutFreqSlider(*apvts.getParameter("Side LowCut Freq"), "Hz"),
+    highCutFreqSlider(*apvts.getParameter("Side HighCut Freq"), "Hz"),
+    lowCutSlopeSlider(*apvts.getParameter("Side LowCut Slope"), "db/Oct"),
+    highCutSlopeSlider(*apvts.getParameter("Side HighCut Slope"), "db/Oct"),
+    peakFreqSliderAttachement(apvts, "Side PeakCut Freq", peakFreqSlider),
+    peakGainSliderAttachement(apvts, "Side Peak Gain", peakGainSlider),
+    peakQualitySliderAttachement(apvts, "Side Peak Quality", peakQualitySlider),
+    lowCutFreqSliderAttachement(apvts, "Side LowCut Freq", lowCutFreqSlider),
+    highCutFreqSliderAttachement(apvts, "Side HighCut Freq", highCutFreqSlider),
+    lowCutSlopeSliderAttachement(apvts, "Side LowCut Slope", lowCutSlopeSlider),
+    highCutSlopeSliderAttachement(apvts, "Side HighCut Slope", highCutSlopeSlider)
+{
+}
+
 ResponseCurveComponent::ResponseCurveComponent(SimpleEQAudioProcessor& p) :
     audioProcessor(p),
+    sideParameters(audioProcessor.apvts, "Side "),
+    stereoModeParam(audioProcessor.apvts.getRawParameterValue("Stereo Mode")),
     leftPathProducer(audioProcessor.leftChannelFifo),
     rightPathProducer(audioProcessor.rightChannelFifo)
 
@@ -159,11 +192,15 @@ ResponseCurveComponent::ResponseCurveComponent(SimpleEQAudioProcessor& p) :
     
     updateChain();
 
-    startTimerHz(60);
+    analyzerThread->addTimeSliceClient(this);
+    startTimerHz(frameRate);
 }
 
 ResponseCurveComponent::~ResponseCurveComponent()
 {
+    // Waits for a running analysis to finish, nothing touches the path producers after this
+    analyzerThread->removeTimeSliceClient(this);
+
     const auto& params = audioProcessor.getParameters();
     for (auto param : params)
     {
@@ -181,58 +218,81 @@ void ResponseCurveComponent::parameterGestureChanged(int parameterIndex, bool ge
 {
 }
 
-void PathProducer::process(juce::Rectangle<float> fftBounds, double sampleRate)
+void PathProducer::process(juce::Rectangle<float> fftBounds, double sampleRate, FFTOrder fftOrder, int overlapOrder)
 {
-    juce::AudioBuffer<float> tempIncomingBuffer;
+    // BPR - a new resolution is built here, on the analyzer thread, and is the only one the
+    // following frames see. Paint keeps drawing the last finished path meanwhile.
+    if (fftOrder != leftChannelFFTDataGenerator.getOrder())
+        leftChannelFFTDataGenerator.changeOrder(fftOrder);
 
-    while (leftChannelFifo->getNumCompleteBuffersAvailable() > 0)
-    {
-        if (leftChannelFifo->getAudioBuffer(tempIncomingBuffer))
-        {
-            auto size = tempIncomingBuffer.getNumSamples();
+    const auto fftSize = leftChannelFFTDataGenerator.getFFTSize();
 
-            juce::FloatVectorOperations::copy(
-                monoBuffer.getWritePointer(0, 0),
-                monoBuffer.getReadPointer(0, size),
-                monoBuffer.getNumSamples() - size);
+    if (leftChannelFifo->isPrepared())
+    {
+        // BPR -> STFT frames every hopSize samples of the ring, whatever the host block size.
+        // Only the newest frame is transformed: the older ones would only be drawn over before
+        // the next repaint, so this runs at most one FFT per display frame.
+        const auto& ring = leftChannelFifo->getRing();
+        const auto hopSize = juce::jmax(1, fftSize >> overlapOrder);
+        // Positions only ever count up, a re-prepare clears the ring by writing silence
+        const auto written = ring.getNumWritten();
 
-            juce::FloatVectorOperations::copy(
-                monoBuffer.getWritePointer(0, monoBuffer.getNumSamples() - size),
-                tempIncomingBuffer.getReadPointer(0, 0),
-                size);
+        const auto newestWindowEnd = written - written % hopSize;
 
-            leftChannelFFTDataGenerator.produceFFTDataForRendering(monoBuffer, -48.f);
+        if (newestWindowEnd > lastWindowEnd)
+        {
+            lastWindowEnd = newestWindowEnd;
+            leftChannelFFTDataGenerator.produceFFTDataForRendering(ring, lastWindowEnd, -48.f);
         }
     }
 
-    
-    const auto fftSize = leftChannelFFTDataGenerator.getFFTSize();
-
     const auto binWidth = sampleRate / (double)fftSize;
 
     while (leftChannelFFTDataGenerator.getNumAvailableFFTDataBlocks() > 0)
     {
-        std::vector<float> fftData;
         if (leftChannelFFTDataGenerator.getFFTData(fftData))
         {
             pathProducer.generatePath(fftData, fftBounds, fftSize, binWidth, -48.f);
         }
     }
 
-    while (pathProducer.getNumPathsAvailable())
+    if (pathProducer.getNumPathsAvailable() > 0)
     {
-        pathProducer.getPath(leftChannelFFTPath);
+        while (pathProducer.getNumPathsAvailable())
+        {
+            pathProducer.getPath(paths.getWriteBuffer());
+        }
+
+        paths.publish();
     }
 }
 
-void ResponseCurveComponent::timerCallback()
+int ResponseCurveComponent::useTimeSlice()
 {
-    auto fftBounds = getAnalysisArea().toFloat();
+    juce::Rectangle<float> fftBounds;
+
+    {
+        const juce::SpinLock::ScopedLockType lock(analysisAreaLock);
+        fftBounds = analysisArea;
+    }
+
     auto sampleRate = audioProcessor.getSampleRate();
 
-    leftPathProducer.process(fftBounds, sampleRate);
-    rightPathProducer.process(fftBounds, sampleRate);
+    auto fftOrder = (FFTOrder)(FFTOrder::order2048 + audioProcessor.getAnalyzerResolution());
+    auto overlapOrder = audioProcessor.getAnalyzerOverlap();
+
+    if (! fftBounds.isEmpty() && sampleRate > 0.0)
+    {
+        leftPathProducer.process(fftBounds, sampleRate, fftOrder, overlapOrder);
+        rightPathProducer.process(fftBounds, sampleRate, fftOrder, overlapOrder);
+    }
+
+    // milliseconds until the analyzer thread runs this component again
+    return 1000 / frameRate;
+}
 
+void ResponseCurveComponent::timerCallback()
+{
     if (parametersChanged.compareAndSetBool(false, true))
     {
         updateChain();
@@ -246,16 +306,107 @@ void ResponseCurveComponent::updateChain()
 {
     //update the mono chain
     auto chainSettings = getChainSettings(audioProcessor.apvts);
+    updateMonoChain(monoChain, chainSettings);
+
+    showSide = stereoModeParam->load() > 0.5f;
+
+    if (showSide)
+        updateMonoChain(sideMonoChain, sideParameters.load());
+
+    for (size_t i = 0; i < chainSettings.bands.size(); ++i)
+    {
+        bandCoefficients[i] = designBandSection(chainSettings.bands[i], audioProcessor.getSampleRate());
+        bandsActive[i] = chainSettings.bands[i].type != Band_Off;
+        bandFreqs[i] = chainSettings.bands[i].freq;
+    }
+    //signal a repaint
+
+}
+
+void ResponseCurveComponent::updateMonoChain(MonoChain& chain, const ChainSettings& chainSettings)
+{
     auto peakCoefficients = makePeakFilter(chainSettings, audioProcessor.getSampleRate());
-    updateCoefficients(monoChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
+    updateCoefficients(chain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
 
     auto lowCutCoefficients = makeLowCutFilter(chainSettings, audioProcessor.getSampleRate());
     auto highCutCoefficients = makeHighCutFilter(chainSettings, audioProcessor.getSampleRate());
 
-    updateCutFilter(monoChain.get<ChainPositions::LowCut>(), lowCutCoefficients, chainSettings.lowCutSlope);
-    updateCutFilter(monoChain.get<ChainPositions::HighCut>(), highCutCoefficients, chainSettings.highCutSlope);
-    //signal a repaint
+    updateCutFilter(chain.get<ChainPositions::LowCut>(), lowCutCoefficients, chainSettings.lowCutSlope);
+    updateCutFilter(chain.get<ChainPositions::HighCut>(), highCutCoefficients, chainSettings.highCutSlope);
+
+    // BPR - parked cuts are off in the processor, the curve stays flat for them too
+    if (isLowCutParked(chainSettings.lowCutFreq))
+        bypassCutFilter(chain.get<ChainPositions::LowCut>());
+
+    if (isHighCutParked(chainSettings.highCutFreq))
+        bypassCutFilter(chain.get<ChainPositions::HighCut>());
+}
+
+double ResponseCurveComponent::getMagnitudeForFrequency(const MonoChain& chain, double freq) const
+{
+    auto& lowCut = chain.get<ChainPositions::LowCut>();
+    auto& peak = chain.get<ChainPositions::Peak>();
+    auto& highCut = chain.get<ChainPositions::HighCut>();
 
+    auto sampleRate = audioProcessor.getSampleRate();
+
+    double mag = 1.f;
+
+    if (!chain.isBypassed <ChainPositions::Peak>())
+        mag *= peak.coefficients->getMagnitudeForFrequency(freq, sampleRate);
+
+    if (!lowCut.isBypassed<0>())
+        mag *= lowCut.get<0>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
+    if (!lowCut.isBypassed<1>())
+        mag *= lowCut.get<1>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
+    if (!lowCut.isBypassed<2>())
+        mag *= lowCut.get<2>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
+    if (!lowCut.isBypassed<3>())
+        mag *= lowCut.get<3>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
+
+    if (!highCut.isBypassed<0>())
+        mag *= highCut.get<0>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
+    if (!highCut.isBypassed<1>())
+        mag *= highCut.get<1>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
+    if (!highCut.isBypassed<2>())
+        mag *= highCut.get<2>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
+    if (!highCut.isBypassed<3>())
+        mag *= highCut.get<3>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
+
+    for (size_t band = 0; band < bandCoefficients.size(); ++band)
+        if (bandsActive[band])
+            mag *= BiquadDesign::getMagnitudeForFrequency(bandCoefficients[band], freq, sampleRate);
+
+    return mag;
+}
+
+juce::Path ResponseCurveComponent::makeResponseCurve(const MonoChain& chain, juce::Rectangle<int> responseArea) const
+{
+    using namespace juce;
+
+    auto w = responseArea.getWidth();
+
+    const double outputMin = responseArea.getBottom();
+    const double outputMax = responseArea.getY();
+    auto map = [outputMin, outputMax](double input)
+    {
+        return jmap(input, -24.0, 24.0, outputMin, outputMax);
+    };
+
+    Path responseCurve;
+
+    for (int i = 0; i < w; ++i)
+    {
+        auto freq = mapToLog10(double(i) / double(w), 20.0, 20000.0);
+        auto y = map(Decibels::gainToDecibels(getMagnitudeForFrequency(chain, freq)));
+
+        if (i == 0)
+            responseCurve.startNewSubPath(responseArea.getX(), y);
+        else
+            responseCurve.lineTo(responseArea.getX() + i, y);
+    }
+
+    return responseCurve;
 }
 
 void ResponseCurveComponent::paint(juce::Graphics& g)
@@ -274,20 +425,17 @@ void ResponseCurveComponent::paint(juce::Graphics& g)
 
     //left channel
 
-    auto leftChannelFFTPath = leftPathProducer.getPath();
-    leftChannelFFTPath.applyTransform(AffineTransform().translation(responseArea.getX(), responseArea.getY()));
+    const auto analyzerTransform = AffineTransform::translation((float)responseArea.getX(), (float)responseArea.getY());
 
     g.setColour(Colours::yellow);
 
-    g.strokePath(leftChannelFFTPath, PathStrokeType(1.f));
+    g.strokePath(leftPathProducer.getPath(), PathStrokeType(1.f), analyzerTransform);
 
     //right channel
 
-    auto rightChannelFFTPath = rightPathProducer.getPath();
-    rightChannelFFTPath.applyTransform(AffineTransform().translation(responseArea.getX(), responseArea.getY()));
     g.setColour(Colours::rebeccapurple);
 
-    g.strokePath(rightChannelFFTPath, PathStrokeType(1.f));
+    g.strokePath(rightPathProducer.getPath(), PathStrokeType(1.f), analyzerTransform);
 
 
 
@@ -296,71 +444,43 @@ void ResponseCurveComponent::paint(juce::Graphics& g)
     g.setColour(Colours::grey);
     g.drawRect(getRenderArea().toFloat(), 3);
 
-    auto& lowCut = monoChain.get<ChainPositions::LowCut>();
-    auto& peak = monoChain.get<ChainPositions::Peak>();
-    auto& highCut = monoChain.get<ChainPositions::HighCut>();
-
-    auto sampleRate = audioProcessor.getSampleRate();
-
-    std::vector<double> mags;
-
-    mags.resize(w);
+    //Band markers, numbered at the top
+    g.setFont(10);
 
-    for (int i = 0; i < w; ++i)
+    for (size_t band = 0; band < bandFreqs.size(); ++band)
     {
-        double mag = 1.f;
-        auto freq = mapToLog10(double(i) / double(w), 20.0, 20000.0);
-
-        if (!monoChain.isBypassed <ChainPositions::Peak>())
-            mag *= peak.coefficients->getMagnitudeForFrequency(freq, sampleRate);
-
-        if (!lowCut.isBypassed<0>())
-            mag *= lowCut.get<0>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        if (!lowCut.isBypassed<1>())
-            mag *= lowCut.get<1>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        if (!lowCut.isBypassed<2>())
-            mag *= lowCut.get<2>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        if (!lowCut.isBypassed<3>())
-            mag *= lowCut.get<3>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-
-        if (!highCut.isBypassed<0>())
-            mag *= highCut.get<0>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        if (!highCut.isBypassed<1>())
-            mag *= highCut.get<1>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        if (!highCut.isBypassed<2>())
-            mag *= highCut.get<2>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        if (!highCut.isBypassed<3>())
-            mag *= highCut.get<3>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-
-        mags[i] = Decibels::gainToDecibels(mag);
-
-        Path responseCurve;
-
-        const double outputMin = responseArea.getBottom();
-        const double outputMax = responseArea.getY();
-        auto map = [outputMin, outputMax](double input)
-        {
-            return jmap(input, -24.0, 24.0, outputMin, outputMax);
-        };
+        if (!bandsActive[band])
+            continue;
 
-        responseCurve.startNewSubPath(responseArea.getX(), map(mags.front()));
+        auto x = responseArea.getX() + w * mapFromLog10(bandFreqs[band], 20.f, 20000.f);
 
-        for (size_t i = 1; i < mags.size(); i++)
-        {
-            responseCurve.lineTo(responseArea.getX() + i, map(mags[i]));
-        }
-
-        
+        g.setColour(Colours::lightskyblue.withAlpha(0.35f));
+        g.drawVerticalLine(roundToInt(x), (float)responseArea.getY(), (float)responseArea.getBottom());
 
-        //Response curve color
         g.setColour(Colours::lightskyblue);
-        g.strokePath(responseCurve, PathStrokeType(0.5f));
+        g.drawText(String((int)band + 1), Rectangle<float>(x - 8, (float)responseArea.getY(), 16, 10), Justification::centred);
     }
+
+    //Side response curve color, drawn below the main one
+    if (showSide)
+    {
+        g.setColour(Colours::orange);
+        g.strokePath(makeResponseCurve(sideMonoChain, responseArea), PathStrokeType(0.5f));
+    }
+
+    //Response curve color
+    g.setColour(Colours::lightskyblue);
+    g.strokePath(makeResponseCurve(monoChain, responseArea), PathStrokeType(0.5f));
 }
 
 void ResponseCurveComponent::resized()
 {
     using namespace juce;
+    {
+        const SpinLock::ScopedLockType lock(analysisAreaLock);
+        analysisArea = getAnalysisArea().toFloat();
+    }
+
     background = Image(Image::PixelFormat::RGB, getWidth(), getHeight(), true);
 
     Graphics g(background);
@@ -513,23 +633,83 @@ SimpleEQAudioProcessorEditor::SimpleEQAudioProcessorEditor(SimpleEQAudioProcesso
     highCutFreqSliderAttachement(audioProcessor.apvts, "HighCut Freq", highCutFreqSlider),
     lowCutSlopeSliderAttachement(audioProcessor.apvts, "LowCut Slope", lowCutSlopeSlider),
     highCutSlopeSliderAttachement(audioProcessor.apvts, "HighCut Slope", highCutSlopeSlider),
-    masterVolumeSliderAttachement(audioProcessor.apvts, "Master Volume", masterVolumeSlider)
+    masterVolumeSliderAttachement(audioProcessor.apvts, "Master Volume", masterVolumeSlider),
+    sideControls(audioProcessor.apvts)
     
 {
     // Make sure that before the constructor has finished, you've set the
     // editor's size to whatever you need it to be.
 
+    analyzerResolutionBox.addItemList(SimpleEQAudioProcessor::getAnalyzerResolutionChoices(), 1);
+    analyzerResolutionBox.setSelectedItemIndex(audioProcessor.getAnalyzerResolution(), juce::dontSendNotification);
+    analyzerResolutionBox.onChange = [this] { audioProcessor.setAnalyzerResolution(analyzerResolutionBox.getSelectedItemIndex()); };
+
+    analyzerOverlapBox.addItemList(SimpleEQAudioProcessor::getAnalyzerOverlapChoices(), 1);
+    analyzerOverlapBox.setSelectedItemIndex(audioProcessor.getAnalyzerOverlap(), juce::dontSendNotification);
+    analyzerOverlapBox.onChange = [this] { audioProcessor.setAnalyzerOverlap(analyzerOverlapBox.getSelectedItemIndex()); };
+
+    for (int band = 1; band <= BiquadCascade::maxParametricBands; ++band)
+    {
+        bandControls.push_back(std::make_unique<BandControls>(audioProcessor.apvts, band));
+        bandSelectorBox.addItem("Band " + juce::String(band), band);
+    }
+
+    bandSelectorBox.setSelectedItemIndex(0, juce::dontSendNotification);
+    bandSelectorBox.onChange = [this] { updateVisibleControls(); };
+
+    if (auto* stereoModeParam = dynamic_cast<juce::AudioParameterChoice*>(audioProcessor.apvts.getParameter("Stereo Mode")))
+        stereoModeBox.addItemList(stereoModeParam->choices, 1);
+
+    stereoModeBoxAttachement = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(audioProcessor.apvts, "Stereo Mode", stereoModeBox);
+    stereoModeBox.onChange = [this] { updateVisibleControls(); };
+    editSideButton.onClick = [this] { updateVisibleControls(); };
+
+    audioProcessor.apvts.state.addListener(this);
+
     for (auto* comp : getComps())
     {
         addAndMakeVisible(comp);
     }
 
+    updateVisibleControls();
+
     setSize(1000, 500);
 }
 
 SimpleEQAudioProcessorEditor::~SimpleEQAudioProcessorEditor()
 {
-   
+    audioProcessor.apvts.state.removeListener(this);
+    cancelPendingUpdate();
+}
+
+void SimpleEQAudioProcessorEditor::handleAsyncUpdate()
+{
+    analyzerResolutionBox.setSelectedItemIndex(audioProcessor.getAnalyzerResolution(), juce::dontSendNotification);
+    analyzerOverlapBox.setSelectedItemIndex(audioProcessor.getAnalyzerOverlap(), juce::dontSendNotification);
+}
+
+// Only the selected band's controls are shown, and the side's cuts and peak replace the main
+// ones while the side is edited. Leaving Mid/Side always goes back to the main ones.
+
+void SimpleEQAudioProcessorEditor::updateVisibleControls()
+{
+    const auto selectedBand = bandSelectorBox.getSelectedItemIndex();
+
+    for (size_t band = 0; band < bandControls.size(); ++band)
+        for (auto* comp : bandControls[band]->getComps())
+            comp->setVisible((int)band == selectedBand);
+
+    const auto midSide = stereoModeBox.getSelectedItemIndex() == 1;
+    const auto editSide = midSide && editSideButton.getToggleState();
+
+    editSideButton.setEnabled(midSide);
+
+    for (auto* comp : std::vector<juce::Component*> { &peakFreqSlider, &peakGainSlider, &peakQualitySlider,
+                                                      &lowCutFreqSlider, &highCutFreqSlider, &lowCutSlopeSlider, &highCutSlopeSlider })
+        comp->setVisible(! editSide);
+
+    for (auto* comp : sideControls.getComps())
+        comp->setVisible(editSide);
 }
 
 //==============================================================================
@@ -561,6 +741,10 @@ void SimpleEQAudioProcessorEditor::resized()
 
 
     auto windowSpacing = bounds.removeFromBottom(bounds.getHeight() * 0.1);
+
+    //Analyzer Resolution, bottom right, Analyzer Overlap left of it
+    analyzerResolutionBox.setBounds(windowSpacing.removeFromRight(160).reduced(8, 4));
+    analyzerOverlapBox.setBounds(windowSpacing.removeFromRight(160).reduced(8, 4));
    
 
 
@@ -610,6 +794,44 @@ void SimpleEQAudioProcessorEditor::resized()
 
     highCutSlopeSlider.setBounds(sliderXpos * 2 + knobRadius * 2, sliderFreqYpos - knobRadius - 10 - knobRadius / 3, knobRadius, knobRadius);
 
+    //Side controls, in the same places as the main ones they replace
+
+    sideControls.peakGainSlider.setBounds(peakGainSlider.getBounds());
+    sideControls.peakFreqSlider.setBounds(peakFreqSlider.getBounds());
+    sideControls.peakQualitySlider.setBounds(peakQualitySlider.getBounds());
+    sideControls.lowCutFreqSlider.setBounds(lowCutFreqSlider.getBounds());
+    sideControls.lowCutSlopeSlider.setBounds(lowCutSlopeSlider.getBounds());
+    sideControls.highCutFreqSlider.setBounds(highCutFreqSlider.getBounds());
+    sideControls.highCutSlopeSlider.setBounds(highCutSlopeSlider.getBounds());
+
+    //Parametric bands, right of the cut knobs: band and type on top, the selected band's knobs below
+
+    auto bandArea = bounds.withLeft(sliderXpos * 2 + knobRadius * 3 + 10).reduced(0, 5);
+
+    auto bandRow = bandArea.removeFromTop(24);
+    bandSelectorBox.setBounds(bandRow.removeFromLeft(bandRow.getWidth() / 2).reduced(4, 0));
+
+    bandArea.removeFromTop(10);
+    auto knobRow = bandArea.removeFromTop(knobRadius);
+    auto knobWidth = knobRow.getWidth() / 3;
+
+    for (auto& band : bandControls)
+    {
+        auto row = knobRow;
+
+        band->typeBox.setBounds(bandRow.reduced(4, 0));
+        band->freqSlider.setBounds(row.removeFromLeft(knobWidth).withSizeKeepingCentre(knobRadius, knobRadius));
+        band->gainSlider.setBounds(row.removeFromLeft(knobWidth).withSizeKeepingCentre(knobRadius, knobRadius));
+        band->qualitySlider.setBounds(row.withSizeKeepingCentre(knobRadius, knobRadius));
+    }
+
+    //Stereo Mode, Edit Side right of it
+
+    bandArea.removeFromTop(10);
+    auto stereoRow = bandArea.removeFromTop(24);
+    stereoModeBox.setBounds(stereoRow.removeFromLeft(stereoRow.getWidth() / 2).reduced(4, 0));
+    editSideButton.setBounds(stereoRow.reduced(4, 0));
+
 
 
  
@@ -642,7 +864,7 @@ juce::Rectangle<int> ResponseCurveComponent::getAnalysisArea()
 
 std::vector<juce::Component*> SimpleEQAudioProcessorEditor::getComps()
 {
-    return
+    std::vector<juce::Component*> comps
     {
         &peakFreqSlider,
         &peakGainSlider,
@@ -652,8 +874,22 @@ std::vector<juce::Component*> SimpleEQAudioProcessorEditor::getComps()
         &highCutFreqSlider,
         &lowCutSlopeSlider,
         &highCutSlopeSlider,
+        &analyzerResolutionBox,
+        &analyzerOverlapBox,
+        &bandSelectorBox,
+        &stereoModeBox,
+        &editSideButton,
         &responseCurveComponent
     };
+
+    for (auto* comp : sideControls.getComps())
+        comps.push_back(comp);
+
+    for (auto& band : bandControls)
+        for (auto* comp : band->getComps())
+            comps.push_back(comp);
+
+    return comps;
 }
 
 
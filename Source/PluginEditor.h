@@ -14,20 +14,30 @@
 enum FFTOrder
 {
     order2048 = 11,
-    order4096 = 11,
-    order8192 = 11
+    order4096 = 12,
+    order8192 = 13,
+    order16384 = 14
 };
 
+static_assert((1 << order16384) <= SingleChannelSampleFifo::maxWindowSize, "the capture ring must hold the largest window");
+
 template<typename BlockType>
 struct FFTDataGenerator
 {
-    void produceFFTDataForRendering(const juce::AudioBuffer<float>& audioData, const float negativeInfinity)
+    // Transforms the fftSize samples of the ring ending at the absolute position end. Returns
+    // false, with nothing produced, when the audio thread overwrote them while they were copied.
+    bool produceFFTDataForRendering(const SampleRing& ring, juce::int64 end, const float negativeInfinity)
     {
         const auto fftSize = getFFTSize();
 
-        fftData.assign(fftData.size(), 0);
-        auto* readIndex = audioData.getReadPointer(0);
-        std::copy(readIndex, readIndex + fftSize, fftData.begin());
+        // Whatever vector the queue handed back last time, resized only if the order changed since
+        fftData.assign((size_t)fftSize * 2, 0.f);
+        const auto audioData = ring.getWindow(end, fftSize);
+        std::copy(audioData.first, audioData.first + audioData.firstSize, fftData.begin());
+        std::copy(audioData.second, audioData.second + audioData.secondSize, fftData.begin() + audioData.firstSize);
+
+        if (! ring.isIntact(end - fftSize))
+            return false;
 
         window->multiplyWithWindowingTable(fftData.data(), fftSize);
 
@@ -47,8 +57,10 @@ struct FFTDataGenerator
         }
 
         fftDataFifo.push(fftData);
+        return true;
     }
 
+    // Allocates, so it runs on the analyzer thread, between two frames
     void changeOrder(FFTOrder newOrder)
     {
         order = newOrder;
@@ -62,6 +74,7 @@ struct FFTDataGenerator
         fftDataFifo.prepare(fftData.size());
     }
 
+    FFTOrder getOrder() const { return order; }
     int getFFTSize() const { return 1 << order; }
     int getNumAvailableFFTDataBlocks() const { return fftDataFifo.getNumAvailableForReading(); }
 
@@ -91,7 +104,9 @@ struct AnalyzerPathGenerator
 
         int numBins = (int)fftSize / 2;
 
-        PathType p;
+        // The path the queue handed back last time, its storage is reused
+        auto& p = nextPath;
+        p.clear();
         p.preallocateSpace(3 * (int)fftBounds.getWidth());
 
         auto map = [bottom, top, negativeInfinity](float v)
@@ -120,7 +135,7 @@ struct AnalyzerPathGenerator
                 p.lineTo(binX, y);
             }
         }
-        pathFifo.push(p);
+        pathFifo.push(nextPath);
     }
     int getNumPathsAvailable() const
     {
@@ -132,6 +147,7 @@ struct AnalyzerPathGenerator
         return pathFifo.pull(path);
     }
 private:
+    PathType nextPath;
     Fifo<PathType> pathFifo;
 
 };
@@ -192,33 +208,99 @@ struct CustomLinearHorizontalSlider : juce::Slider
         juce::Slider::TextBoxAbove) {}
 };
 
+// BPR - the controls of one parametric band, the editor only shows the selected band's
+struct BandControls
+{
+    BandControls(juce::AudioProcessorValueTreeState& apvts, int band);
+
+    juce::ComboBox typeBox;
+    RotarySliderWithLabels freqSlider, gainSlider, qualitySlider;
+
+    std::vector<juce::Component*> getComps() { return { &typeBox, &freqSlider, &gainSlider, &qualitySlider }; }
+
+private:
+    using Attachement = juce::AudioProcessorValueTreeState::SliderAttachment;
+
+    // Made once the box has its items, the attachment selects the current one right away
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> typeBoxAttachement;
+
+    Attachement freqSliderAttachement,
+                gainSliderAttachement,
+                qualitySliderAttachement;
+};
+
+// BPR - the "Side " cuts and peak, in place of the main ones while the side is edited
+struct SideControls
+{
+    SideControls(juce::AudioProcessorValueTreeState& apvts);
+
+    RotarySliderWithLabels lowCutFreqSlider,
+                           highCutFreqSlider,
+                           lowCutSlopeSlider,
+                           highCutSlopeSlider;
+
+    CustomLinearVerticalSlider peakGainSlider;
+
+    CustomLinearHorizontalSlider peakFreqSlider,
+                                 peakQualitySlider;
+
+    std::vector<juce::Component*> getComps()
+    {
+        return { &peakFreqSlider, &peakGainSlider, &peakQualitySlider,
+                 &lowCutFreqSlider, &highCutFreqSlider, &lowCutSlopeSlider, &highCutSlopeSlider };
+    }
+
+private:
+    using Attachement = juce::AudioProcessorValueTreeState::SliderAttachment;
+
+    Attachement
+        peakFreqSliderAttachement,
+        peakGainSliderAttachement,
+        peakQualitySliderAttachement,
+        lowCutFreqSliderAttachement,
+        highCutFreqSliderAttachement,
+        lowCutSlopeSliderAttachement,
+        highCutSlopeSliderAttachement;
+};
+
 struct PathProducer
 {
-    PathProducer(SingleChannelSampleFifo<SimpleEQAudioProcessor::BlockType>& scsf) :
+    PathProducer(SingleChannelSampleFifo& scsf) :
         leftChannelFifo(&scsf)
     {
         leftChannelFFTDataGenerator.changeOrder(FFTOrder::order2048);
-        monoBuffer.setSize(1, leftChannelFFTDataGenerator.getFFTSize());
-
     }
 
-    void process(juce::Rectangle<float> fftBounds, double sampleRate);
-    juce::Path getPath() { return leftChannelFFTPath; }
+    // Analyzer thread. overlapOrder: the hop is fftSize >> overlapOrder, 0 for no overlap
+    void process(juce::Rectangle<float> fftBounds, double sampleRate, FFTOrder fftOrder, int overlapOrder);
+
+    // Message thread: the newest path the analyzer thread finished
+    const juce::Path& getPath()
+    {
+        paths.pull();
+        return paths.getReadBuffer();
+    }
 
 private:
-    SingleChannelSampleFifo<SimpleEQAudioProcessor::BlockType>* leftChannelFifo;
+    SingleChannelSampleFifo* leftChannelFifo;
+
+    // Absolute ring position the last transformed window ended at
+    juce::int64 lastWindowEnd = 0;
 
-    juce::AudioBuffer<float> monoBuffer;
+    // Swapped with the generator's queue, so it always holds a previously used vector
+    std::vector<float> fftData;
 
     FFTDataGenerator<std::vector<float>> leftChannelFFTDataGenerator;
 
     AnalyzerPathGenerator<juce::Path> pathProducer;
 
-    juce::Path leftChannelFFTPath;
+    // Latest value slot between the analyzer thread and paint
+    TripleBuffer<juce::Path> paths;
 
 };
 
-struct ResponseCurveComponent : juce::Component, juce::AudioProcessorParameter::Listener, juce::Timer
+struct ResponseCurveComponent : juce::Component, juce::AudioProcessorParameter::Listener, juce::Timer,
+                                private juce::TimeSliceClient
 {
     ResponseCurveComponent(SimpleEQAudioProcessor&);
     ~ResponseCurveComponent();
@@ -241,6 +323,22 @@ private:
 
     MonoChain monoChain;
 
+    // BPR - in Mid/Side the side's cuts and peak get a curve of their own, the bands act on both
+    MonoChain sideMonoChain;
+    ChainSettingsParameters sideParameters;
+    std::atomic<float>* stereoModeParam = nullptr;
+    bool showSide = false;
+
+    // BPR - the parametric bands are drawn from the same closed form designs the processor uses,
+    // each active band also gets a marker line at its frequency
+    std::array<BiquadCoefficients, BiquadCascade::maxParametricBands> bandCoefficients;
+    std::array<bool, BiquadCascade::maxParametricBands> bandsActive {};
+    std::array<float, BiquadCascade::maxParametricBands> bandFreqs {};
+
+    void updateMonoChain(MonoChain& chain, const ChainSettings& chainSettings);
+    double getMagnitudeForFrequency(const MonoChain& chain, double freq) const;
+    juce::Path makeResponseCurve(const MonoChain& chain, juce::Rectangle<int> responseArea) const;
+
     juce::Image background;
 
     juce::Rectangle<int> getRenderArea();
@@ -249,6 +347,25 @@ private:
 
     PathProducer leftPathProducer, rightPathProducer;
 
+    // BPR - Spectrum analyzer: FFTs and paths are made on a shared background thread, paint
+    // only draws the newest path of each channel
+
+    static constexpr int frameRate = 60;
+
+    struct AnalyzerThread : juce::TimeSliceThread
+    {
+        AnalyzerThread() : juce::TimeSliceThread("EQQ Spectrum Analyzer") { startThread(); }
+        ~AnalyzerThread() override { stopThread(1000); }
+    };
+
+    juce::SharedResourcePointer<AnalyzerThread> analyzerThread;
+
+    // Set in resized, read by the analyzer thread
+    juce::SpinLock analysisAreaLock;
+    juce::Rectangle<float> analysisArea;
+
+    int useTimeSlice() override;
+
    
 
 };
@@ -257,7 +374,9 @@ private:
 //==============================================================================
 /**
 */
-class SimpleEQAudioProcessorEditor : public juce::AudioProcessorEditor
+class SimpleEQAudioProcessorEditor : public juce::AudioProcessorEditor,
+                                      private juce::ValueTree::Listener,
+                                      private juce::AsyncUpdater
 
 {
 public:
@@ -290,6 +409,21 @@ private:
     CustomLinearHorizontalSlider peakFreqSlider,
                                  peakQualitySlider;
 
+    juce::ComboBox analyzerResolutionBox,
+                   analyzerOverlapBox;
+
+    // Parametric bands: the selector picks which band's controls are shown
+    juce::ComboBox bandSelectorBox;
+    std::vector<std::unique_ptr<BandControls>> bandControls;
+
+    // Stereo mode, and in Mid/Side a toggle that swaps the cut and peak controls for the side's
+    juce::ComboBox stereoModeBox;
+    juce::ToggleButton editSideButton { "Edit Side" };
+    SideControls sideControls;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> stereoModeBoxAttachement;
+
+    void updateVisibleControls();
+
  
                                
     
@@ -305,6 +439,10 @@ private:
         highCutFreqSliderAttachement,
         lowCutSlopeSliderAttachement,
         highCutSlopeSliderAttachement;
+
+    // The analyzer settings live in the state tree, a restored session moves the boxes along
+    void valueTreeRedirected(juce::ValueTree&) override { triggerAsyncUpdate(); }
+    void handleAsyncUpdate() override;
     
     ResponseCurveComponent responseCurveComponent;
 
@@ -22,10 +22,29 @@ SimpleEQAudioProcessor::SimpleEQAudioProcessor()
                        )
 #endif
 {
+    cutFilterFormParam = apvts.getRawParameterValue("Cut Filter Form");
+    processingModeParam = apvts.getRawParameterValue("Processing Mode");
+    filterEngineParam = apvts.getRawParameterValue("Filter Engine");
+    stereoModeParam = apvts.getRawParameterValue("Stereo Mode");
+
+    masterVolumeParam = dynamic_cast<juce::AudioParameterFloat*>(apvts.getParameter("Master Volume"));
+    jassert(masterVolumeParam != nullptr);
+
+    for (auto* param : getParameters())
+        if (auto* rangedParam = dynamic_cast<juce::RangedAudioParameter*>(param))
+            apvts.addParameterListener(rangedParam->paramID, this);
+
+    designThread->addTimeSliceClient(this);
 }
 
 SimpleEQAudioProcessor::~SimpleEQAudioProcessor()
 {
+    cancelPendingUpdate();
+    designThread->removeTimeSliceClient(this);
+
+    for (auto* param : getParameters())
+        if (auto* rangedParam = dynamic_cast<juce::RangedAudioParameter*>(param))
+            apvts.removeParameterListener(rangedParam->paramID, this);
 }
 
 //==============================================================================
@@ -63,7 +82,9 @@ bool SimpleEQAudioProcessor::isMidiEffect() const
 
 double SimpleEQAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    const auto sampleRate = getSampleRate();
+
+    return sampleRate > 0.0 ? tailSamples.load() / sampleRate : 0.0;
 }
 
 int SimpleEQAudioProcessor::getNumPrograms()
@@ -99,16 +120,65 @@ void SimpleEQAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlo
 
     spec.maximumBlockSize = samplesPerBlock;
 
-    spec.numChannels = 1;
+    // BPR - One lane per channel of the bus, the engines group them Register::size() at a time
+
+    spec.numChannels = (juce::uint32)juce::jmax(getTotalNumInputChannels(), getTotalNumOutputChannels());
 
     spec.sampleRate = sampleRate;
 
-    leftChain.prepare(spec);
-    rightChain.prepare(spec);
+    const auto processingMode = getProcessingMode();
+
+    // BPR - The precision is set by the host before this call, only its engines get prepared
+
+    const auto useDoublePrecision = getProcessingPrecision() == doublePrecision;
+
+    if (useDoublePrecision)
+        prepareEngines<double>(spec, processingMode);
+    else
+        prepareEngines<float>(spec, processingMode);
+
+    svfEngineApplied = false;
+    svfHandover = false;
+
+    // BPR - Linear phase mode, set up the same way when one of its parameters changes later
+
+    configureLinearPhase(sampleRate, samplesPerBlock, (int)spec.numChannels, true);
+
+    // BPR - Refactored Filter, designed here once so the first block already has coefficients
+
+    designSampleRate.store(sampleRate);
+    designCoefficients(true);
+
+    // The audio thread is stopped, the setup goes in straight away instead of crossfading
+    if (linearPhaseSetups.pull())
+        std::swap(linearPhaseCurrent, linearPhaseSetups.getReadBuffer());
+
+    handoverRemaining = 0;
 
-    // BPR - Refactored Filter
+    if (linearPhaseCurrent.enabled)
+    {
+        linearPhaseKernels.pull();
+        linearPhaseCurrent.convolver.setKernel(linearPhaseKernels.getReadBuffer().main);
+
+        if (linearPhaseCurrent.midSide)
+            linearPhaseCurrent.sideConvolver.setKernel(linearPhaseKernels.getReadBuffer().side);
+    }
+
+    mainPath.smoothed.reset(sampleRate, mainPath.parameters.load());
+    sidePath.smoothed.reset(sampleRate, sidePath.parameters.load());
 
-    updateFilters();
+    midSideApplied = false;
+
+    if (useDoublePrecision)
+        updateFilters<double>();
+    else
+        updateFilters<float>();
+
+    masterGain.reset(sampleRate, masterGainRampSeconds);
+    masterGain.setCurrentAndTargetValue(getMasterGainTarget());
+
+    silentSamples.assign(spec.numChannels, 0);
+    sleeping = false;
 
     leftChannelFifo.prepare(samplesPerBlock);
     rightChannelFifo.prepare(samplesPerBlock);
@@ -117,6 +187,20 @@ void SimpleEQAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlo
     // initialisation that you need..
 }
 
+template<typename SampleType>
+void SimpleEQAudioProcessor::prepareEngines(const juce::dsp::ProcessSpec& spec, BiquadProcessingMode processingMode)
+{
+    auto& e = getEngines<SampleType>();
+
+    e.filterChain.prepare(spec, processingMode);
+    e.filterChain.setMidSide(false);
+    e.lowCutParallel.prepare((int)spec.numChannels, spec.sampleRate);
+    e.highCutParallel.prepare((int)spec.numChannels, spec.sampleRate);
+    e.svfChain.prepare(spec);
+    e.handoverBuffer.setSize((int)spec.numChannels, (int)spec.maximumBlockSize);
+    e.svfHandoverBuffer.setSize((int)spec.numChannels, (int)spec.maximumBlockSize);
+}
+
 void SimpleEQAudioProcessor::releaseResources()
 {
     // When playback stops, you can use this as an opportunity to free up any
@@ -130,12 +214,16 @@ bool SimpleEQAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts)
     juce::ignoreUnused (layouts);
     return true;
   #else
-    // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
+    // BPR - Every channel runs the same chain, so surround buses work as well as mono / stereo.
     // Some plugin hosts, such as certain GarageBand versions, will only
     // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    const auto& outputSet = layouts.getMainOutputChannelSet();
+
+    if (outputSet != juce::AudioChannelSet::mono()
+     && outputSet != juce::AudioChannelSet::stereo()
+     && outputSet != juce::AudioChannelSet::create5point1()
+     && outputSet != juce::AudioChannelSet::create7point1()
+     && outputSet != juce::AudioChannelSet::create7point1point4())
         return false;
 
     // This checks if the input layout matches the output layout
@@ -150,6 +238,21 @@ bool SimpleEQAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts)
 #endif
 
 void SimpleEQAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+{
+    juce::ignoreUnused(midiMessages);
+    process(buffer);
+}
+
+void SimpleEQAudioProcessor::processBlock (juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages)
+{
+    juce::ignoreUnused(midiMessages);
+    process(buffer);
+}
+
+// BPR -> both processBlock overloads, SampleType picks the engines
+
+template<typename SampleType>
+void SimpleEQAudioProcessor::process(juce::AudioBuffer<SampleType>& buffer)
 {
     juce::ScopedNoDenormals noDenormals;
     auto totalNumInputChannels  = getTotalNumInputChannels();
@@ -167,28 +270,255 @@ void SimpleEQAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juc
 
     //!!!!!!!!!!!!!!!!!! always update your parameters BEFORE audio goes through it !!!!!!!!!!!!!!!!
 
-    // BPR - Refactored Filter Updater
-    
-    updateFilters();
+    // BPR - Refactored Filter Updater, picks up coefficients designed on the background thread
+    // for every band that isn't in the middle of a ramp
+
+    pullLinearPhaseUpdates<SampleType>();
+
+    mainPath.smoothed.setTargets(mainPath.parameters.load());
+    sidePath.smoothed.setTargets(sidePath.parameters.load());
 
-    // BPR - Processing the DSP
+    // The side settings only have to follow their ramps while the biquad engine runs mid/side
+    if (shouldUseSvfEngine() || ! midSideApplied)
+        sidePath.smoothed.skipSmoothing();
 
-    juce::dsp::AudioBlock<float> block(buffer);
-     
-    auto leftBlock = block.getSingleChannelBlock(0);
-    auto rightBlock = block.getSingleChannelBlock(1);
+    // Only the minimum phase engines follow the ramps, linear phase designs the targets
+    const auto minimumPhaseRunning = ! linearPhaseCurrent.enabled || (handoverRemaining > 0 && ! linearPhaseOutgoing.enabled);
 
-    juce::dsp::ProcessContextReplacing<float> leftContext(leftBlock);
-    juce::dsp::ProcessContextReplacing<float> rightContext(rightBlock);
+    if (! minimumPhaseRunning)
+        mainPath.smoothed.skipSmoothing();
+
+    masterGain.setTargetValue(getMasterGainTarget());
+
+    // BPR - Silent input and the filters have rung out, the output would be silent as well
+
+    if (isSilentAndDecayed<SampleType>(buffer))
+    {
+        mainPath.smoothed.skipSmoothing();
+        sidePath.smoothed.skipSmoothing();
+        masterGain.setCurrentAndTargetValue(masterGain.getTargetValue());
+        buffer.clear();
 
-    leftChain.process(leftContext);
-    rightChain.process(rightContext);
+        // Nothing left to fade between, the setup coming in starts from silence like the rest
+        handoverRemaining = 0;
+    }
+    else if (handoverRemaining > 0)
+    {
+        processHandover(buffer);
+    }
+    else
+    {
+        processEngines(buffer, linearPhaseCurrent);
+    }
 
     leftChannelFifo.update(buffer);
     rightChannelFifo.update(buffer);
 
 }
 
+// BPR -> one block through whichever engine the setup selects: the linear phase convolver,
+// or the SVF / biquad engines
+
+template<typename SampleType>
+void SimpleEQAudioProcessor::processEngines(juce::AudioBuffer<SampleType>& buffer, LinearPhaseSetup& setup)
+{
+    auto& e = getEngines<SampleType>();
+    juce::dsp::AudioBlock<SampleType> block(buffer);
+
+    if (setup.enabled)
+    {
+        processLinearPhase(block, setup);
+        applyMasterGain(buffer);
+        return;
+    }
+
+    // An engine handover works on a copy of the input, blocks longer than prepared go through in parts
+
+    const auto maxBlockSize = e.svfHandoverBuffer.getNumSamples();
+
+    if ((svfHandover || shouldUseSvfEngine() != svfEngineApplied) && maxBlockSize > 0 && buffer.getNumSamples() > maxBlockSize)
+    {
+        for (int start = 0; start < buffer.getNumSamples(); start += maxBlockSize)
+        {
+            juce::AudioBuffer<SampleType> part(buffer.getArrayOfWritePointers(), buffer.getNumChannels(), start,
+                                               juce::jmin(maxBlockSize, buffer.getNumSamples() - start));
+            processEngines(part, setup);
+        }
+
+        return;
+    }
+
+    // BPR - The SVF engine does its own cut and peak updates, filterChain only runs the bands meanwhile
+
+    if (shouldUseSvfEngine())
+    {
+        processSvf(block);
+        return;
+    }
+
+    const auto leavingSvfEngine = svfEngineApplied;
+
+    if (leavingSvfEngine)
+    {
+        // The bands ran in filterChain all along, the cuts and the peak go back in under its
+        // crossfade. Until that is over the SVF chain keeps running on a copy of the input, and
+        // the sections being faded out run on its output. The parallel cut state is stale: the
+        // low cut comes in ahead of the cascade on the input alone, the high cut runs after the
+        // crossfade and fades in with it.
+        svfEngineApplied = false;
+        e.filterChain.beginCrossfade();
+        svfHandover = true;
+        e.lowCutParallel.reset();
+        e.highCutParallel.deactivate();
+    }
+
+    if (parallelCutsApplied)
+        mainPath.smoothed.skipCutSmoothing();
+
+    e.filterChain.setProcessingMode(getProcessingMode());
+    updateFilters<SampleType>(leavingSvfEngine);
+
+    // BPR - Nothing to compute once every section is transparent. The cascade only gets there
+    // after crossfading out of the sections it dropped, with their state, so this can't click.
+
+    if (isTransparent<SampleType>())
+        return;
+
+    // The sections filterChain fades out of run on the block as well, or on the SVF chain's
+    // output while it hands the cuts and the peak back
+    auto outgoingInput = block;
+
+    if (svfHandover && e.filterChain.isCrossfading())
+    {
+        outgoingInput = getSvfHandoverBlock(block);
+        e.svfChain.process(outgoingInput);
+    }
+    else
+    {
+        svfHandover = false;
+    }
+
+    // BPR - Processing the DSP, split into smoothing blocks only while a parameter is ramping
+
+    if (! isSmoothing())
+    {
+        processChain(block, outgoingInput);
+    }
+    else
+    {
+        const auto numSamples = block.getNumSamples();
+        const auto smoothingBlockSize = (size_t)SmoothedChainSettings::smoothingBlockSize;
+
+        for (size_t start = 0; start < numSamples; start += smoothingBlockSize)
+        {
+            const auto num = juce::jmin(smoothingBlockSize, numSamples - start);
+
+            updateSmoothedFilters<SampleType>((int)num);
+            processChain(block.getSubBlock(start, num), outgoingInput.getSubBlock(start, num));
+        }
+    }
+}
+
+// A copy of the block in svfHandoverBuffer, which processEngines() keeps at least as long
+
+template<typename SampleType>
+juce::dsp::AudioBlock<SampleType> SimpleEQAudioProcessor::getSvfHandoverBlock(const juce::dsp::AudioBlock<SampleType>& block)
+{
+    auto& scratch = getEngines<SampleType>().svfHandoverBuffer;
+
+    const auto numChannels = (size_t)juce::jmin((int)block.getNumChannels(), scratch.getNumChannels());
+
+    auto copy = juce::dsp::AudioBlock<SampleType>(scratch).getSubsetChannelBlock(0, numChannels).getSubBlock(0, block.getNumSamples());
+    copy.copyFrom(block);
+    return copy;
+}
+
+// BPR -> mid/side is encoded the way the biquad engine does it, mid = (L + R) / 2, side = (L - R) / 2
+
+template<typename SampleType>
+void SimpleEQAudioProcessor::processLinearPhase(const juce::dsp::AudioBlock<SampleType>& block, LinearPhaseSetup& setup)
+{
+    if (! setup.midSide || block.getNumChannels() != 2)
+    {
+        setup.convolver.process(block);
+        return;
+    }
+
+    const auto numSamples = (int)block.getNumSamples();
+    auto* left = block.getChannelPointer(0);
+    auto* right = block.getChannelPointer(1);
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const auto mid = (left[i] + right[i]) * (SampleType)0.5;
+        const auto side = (left[i] - right[i]) * (SampleType)0.5;
+
+        left[i] = mid;
+        right[i] = side;
+    }
+
+    setup.convolver.process(block.getSingleChannelBlock(0));
+    setup.sideConvolver.process(block.getSingleChannelBlock(1));
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const auto mid = left[i];
+        const auto side = right[i];
+
+        left[i] = mid + side;
+        right[i] = mid - side;
+    }
+}
+
+// BPR -> both setups run, the outgoing one on a copy of the input, and the output moves from
+// the outgoing to the current one once the current one is warmed up. Both get the same master
+// gain ramp.
+
+template<typename SampleType>
+void SimpleEQAudioProcessor::processHandover(juce::AudioBuffer<SampleType>& buffer)
+{
+    auto& scratch = getEngines<SampleType>().handoverBuffer;
+
+    const auto numChannels = juce::jmin(buffer.getNumChannels(), scratch.getNumChannels());
+    const auto maxBlockSize = juce::jmax(1, scratch.getNumSamples());
+
+    for (int start = 0; start < buffer.getNumSamples(); start += maxBlockSize)
+    {
+        const auto num = juce::jmin(maxBlockSize, buffer.getNumSamples() - start);
+
+        // References to the samples, nothing is allocated for these
+        juce::AudioBuffer<SampleType> current(buffer.getArrayOfWritePointers(), numChannels, start, num);
+        juce::AudioBuffer<SampleType> outgoing(scratch.getArrayOfWritePointers(), numChannels, 0, num);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            outgoing.copyFrom(ch, 0, current, ch, 0, num);
+
+        const auto gain = masterGain;
+        processEngines(outgoing, linearPhaseOutgoing);
+        masterGain = gain;
+        processEngines(current, linearPhaseCurrent);
+
+        const auto fadeLength = (float)juce::jmax(1, handoverFadeLength);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            auto* destination = current.getWritePointer(ch);
+            const auto* source = outgoing.getReadPointer(ch);
+
+            for (int i = 0; i < num; ++i)
+            {
+                // Counts down to 1 on the last sample of the fade, which is all current
+                const auto remaining = (float)(handoverRemaining - i);
+                const auto mix = (SampleType)juce::jlimit(0.f, 1.f, (fadeLength - remaining + 1.f) / fadeLength);
+
+                destination[i] = source[i] + mix * (destination[i] - source[i]);
+            }
+        }
+
+        handoverRemaining = juce::jmax(0, handoverRemaining - num);
+    }
+}
+
 //==============================================================================
 bool SimpleEQAudioProcessor::hasEditor() const
 {
@@ -224,7 +554,8 @@ void SimpleEQAudioProcessor::setStateInformation (const void* data, int sizeInBy
     if (tree.isValid())
     {
         apvts.replaceState(tree);
-        updateFilters();
+        readAnalyzerSettings();
+        ++settingsEpoch;
     }
 
 
@@ -232,140 +563,1399 @@ void SimpleEQAudioProcessor::setStateInformation (const void* data, int sizeInBy
 }
 
 
+void SimpleEQAudioProcessor::setAnalyzerOverlap(int overlapIndex)
+{
+    overlapIndex = juce::jlimit(0, getAnalyzerOverlapChoices().size() - 1, overlapIndex);
+
+    apvts.state.setProperty("AnalyzerOverlap", overlapIndex, nullptr);
+    analyzerOverlap.store(overlapIndex, std::memory_order_relaxed);
+}
+
+void SimpleEQAudioProcessor::setAnalyzerResolution(int resolutionIndex)
+{
+    resolutionIndex = juce::jlimit(0, getAnalyzerResolutionChoices().size() - 1, resolutionIndex);
+
+    apvts.state.setProperty("AnalyzerResolution", resolutionIndex, nullptr);
+    analyzerResolution.store(resolutionIndex, std::memory_order_relaxed);
+}
+
+// Sessions without the properties keep the defaults
+void SimpleEQAudioProcessor::readAnalyzerSettings()
+{
+    const auto overlapIndex = (int)apvts.state.getProperty("AnalyzerOverlap", 1);
+    analyzerOverlap.store(juce::jlimit(0, getAnalyzerOverlapChoices().size() - 1, overlapIndex), std::memory_order_relaxed);
+
+    const auto resolutionIndex = (int)apvts.state.getProperty("AnalyzerResolution", 0);
+    analyzerResolution.store(juce::jlimit(0, getAnalyzerResolutionChoices().size() - 1, resolutionIndex), std::memory_order_relaxed);
+}
+
+
 // BPR -> Chain setting getter
 
 ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts)
+{
+    return ChainSettingsParameters(apvts).load();
+}
+
+ChainSettingsParameters::ChainSettingsParameters(juce::AudioProcessorValueTreeState& apvts, const juce::String& prefix)
+    : lowCutFreq(apvts.getRawParameterValue(prefix + "LowCut Freq")),
+      highCutFreq(apvts.getRawParameterValue(prefix + "HighCut Freq")),
+      peakFreq(apvts.getRawParameterValue(prefix + "PeakCut Freq")),
+      peakGain(apvts.getRawParameterValue(prefix + "Peak Gain")),
+      peakQuality(apvts.getRawParameterValue(prefix + "Peak Quality")),
+      lowCutSlope(apvts.getRawParameterValue(prefix + "LowCut Slope")),
+      highCutSlope(apvts.getRawParameterValue(prefix + "HighCut Slope")),
+      masterVolume(apvts.getRawParameterValue("Master Volume"))
+{
+    if (prefix.isNotEmpty())
+        return;
+
+    for (int i = 0; i < (int)bands.size(); ++i)
+    {
+        const auto bandPrefix = "Band " + juce::String(i + 1) + " ";
+        auto& band = bands[(size_t)i];
+
+        band.type = apvts.getRawParameterValue(bandPrefix + "Type");
+        band.freq = apvts.getRawParameterValue(bandPrefix + "Freq");
+        band.gain = apvts.getRawParameterValue(bandPrefix + "Gain");
+        band.quality = apvts.getRawParameterValue(bandPrefix + "Quality");
+    }
+}
+
+ChainSettings ChainSettingsParameters::load() const
 {
     ChainSettings settings;
 
-    settings.lowCutFreq = apvts.getRawParameterValue("LowCut Freq")->load();
-    settings.highCutFreq = apvts.getRawParameterValue("HighCut Freq")->load();
-    settings.peakFreq = apvts.getRawParameterValue("PeakCut Freq")->load();
-    settings.peakGainInDecibels = apvts.getRawParameterValue("Peak Gain")->load();
-    settings.peakQuality = apvts.getRawParameterValue("Peak Quality")->load();
-    settings.lowCutSlope = static_cast<Slope>(apvts.getRawParameterValue("LowCut Slope")->load());
-    settings.highCutSlope = static_cast<Slope>(apvts.getRawParameterValue("HighCut Slope")->load());
-    settings.masterVolume = apvts.getRawParameterValue("Master Volume")->load();
+    settings.lowCutFreq = lowCutFreq->load();
+    settings.highCutFreq = highCutFreq->load();
+    settings.peakFreq = peakFreq->load();
+    settings.peakGainInDecibels = peakGain->load();
+    settings.peakQuality = peakQuality->load();
+    settings.lowCutSlope = static_cast<Slope>(lowCutSlope->load());
+    settings.highCutSlope = static_cast<Slope>(highCutSlope->load());
+    settings.masterVolume = masterVolume->load();
+
+    for (size_t i = 0; i < bands.size(); ++i)
+    {
+        if (bands[i].type == nullptr)
+            continue;
+
+        auto& band = settings.bands[i];
+
+        band.type = static_cast<BandType>(bands[i].type->load());
+        band.freq = bands[i].freq->load();
+        band.gainInDecibels = bands[i].gain->load();
+        band.quality = bands[i].quality->load();
+    }
 
     return settings;
 }
 
-Coefficients makePeakFilter(const ChainSettings& chainSettings, double sampleRate)
+// BPR -> Smoothing
+
+void SmoothedChainSettings::reset(double sampleRate, const ChainSettings& chainSettings)
 {
-    return juce::dsp::IIR::Coefficients<float>::makePeakFilter(sampleRate,
-        chainSettings.peakFreq,
-        chainSettings.peakQuality,
-        juce::Decibels::decibelsToGain(chainSettings.peakGainInDecibels));
+    // Ramp length in seconds, long enough to hide zipper noise but still follow fast automation
+    constexpr double rampLength = 0.05;
+
+    peakFreq.reset(sampleRate, rampLength);
+    peakGainInDecibels.reset(sampleRate, rampLength);
+    peakQuality.reset(sampleRate, rampLength);
+    lowCutFreq.reset(sampleRate, rampLength);
+    highCutFreq.reset(sampleRate, rampLength);
+
+    peakFreq.setCurrentAndTargetValue(chainSettings.peakFreq);
+    peakGainInDecibels.setCurrentAndTargetValue(chainSettings.peakGainInDecibels);
+    peakQuality.setCurrentAndTargetValue(chainSettings.peakQuality);
+    lowCutFreq.setCurrentAndTargetValue(chainSettings.lowCutFreq);
+    highCutFreq.setCurrentAndTargetValue(chainSettings.highCutFreq);
+
+    for (size_t i = 0; i < bands.size(); ++i)
+    {
+        bands[i].freq.reset(sampleRate, rampLength);
+        bands[i].gainInDecibels.reset(sampleRate, rampLength);
+        bands[i].quality.reset(sampleRate, rampLength);
+        bands[i].setCurrentAndTargetValues(chainSettings.bands[i]);
+    }
+
+    targets = chainSettings;
 }
 
-void updateCoefficients(Coefficients& old, const Coefficients& replacements)
+void SmoothedChainSettings::SmoothedBand::setCurrentAndTargetValues(const BandSettings& band)
 {
-    *old = *replacements;
+    freq.setCurrentAndTargetValue(band.freq);
+    gainInDecibels.setCurrentAndTargetValue(band.gainInDecibels);
+    quality.setCurrentAndTargetValue(band.quality);
 }
 
-// BPR -> refactored updatePeakFilterFunction
-
-void SimpleEQAudioProcessor::updatePeakFilter(const ChainSettings& chainSettings)
+void SmoothedChainSettings::setTargets(const ChainSettings& chainSettings)
 {
-    auto peakCoefficients = makePeakFilter(chainSettings, getSampleRate());
+    peakFreq.setTargetValue(chainSettings.peakFreq);
+    peakGainInDecibels.setTargetValue(chainSettings.peakGainInDecibels);
+    peakQuality.setTargetValue(chainSettings.peakQuality);
+    lowCutFreq.setTargetValue(chainSettings.lowCutFreq);
+    highCutFreq.setTargetValue(chainSettings.highCutFreq);
+
+    for (size_t i = 0; i < bands.size(); ++i)
+    {
+        const auto& band = chainSettings.bands[i];
+
+        // A band that is off has nothing to ramp, and one that changes type has nothing to ramp from
+        if (band.type == Band_Off || band.type != targets.bands[i].type)
+        {
+            bands[i].setCurrentAndTargetValues(band);
+            continue;
+        }
+
+        bands[i].freq.setTargetValue(band.freq);
+        bands[i].gainInDecibels.setTargetValue(band.gainInDecibels);
+        bands[i].quality.setTargetValue(band.quality);
+    }
 
-    *leftChain.get<ChainPositions::Peak>().coefficients = *peakCoefficients;
-    *rightChain.get<ChainPositions::Peak>().coefficients = *peakCoefficients;
+    targets = chainSettings;
+}
 
-    updateCoefficients(leftChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
-    updateCoefficients(rightChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
+bool SmoothedChainSettings::isBandsSmoothing() const
+{
+    return std::any_of(bands.begin(), bands.end(), [](const SmoothedBand& band) { return band.isSmoothing(); });
 }
 
-void SimpleEQAudioProcessor::updateLowCutFilters(const ChainSettings& chainSettings)
+ParametricBandSettings SmoothedChainSettings::advanceBands(int numSamples)
 {
-    auto cutCoefficients = makeLowCutFilter(chainSettings, getSampleRate());
-    auto& leftLowCut = leftChain.get<ChainPositions::LowCut>();
-    auto& rightLowCut = rightChain.get<ChainPositions::LowCut>();
+    auto current = targets.bands;
+
+    for (size_t i = 0; i < bands.size(); ++i)
+    {
+        if (! bands[i].isSmoothing())
+            continue;
+
+        current[i].freq = bands[i].freq.skip(numSamples);
+        current[i].gainInDecibels = bands[i].gainInDecibels.skip(numSamples);
+        current[i].quality = bands[i].quality.skip(numSamples);
+    }
+
+    return current;
+}
 
+ChainSettings SmoothedChainSettings::advance(int numSamples)
+{
+    auto current = targets;
 
-    updateCutFilter(rightLowCut, cutCoefficients, chainSettings.lowCutSlope);
-    updateCutFilter(leftLowCut, cutCoefficients, chainSettings.lowCutSlope);
+    current.peakFreq = peakFreq.skip(numSamples);
+    current.peakGainInDecibels = peakGainInDecibels.skip(numSamples);
+    current.peakQuality = peakQuality.skip(numSamples);
+    current.lowCutFreq = lowCutFreq.skip(numSamples);
+    current.highCutFreq = highCutFreq.skip(numSamples);
+    current.bands = advanceBands(numSamples);
 
+    return current;
 }
 
-void SimpleEQAudioProcessor::updateHighCutFilters(const ChainSettings& chainSettings)
+ChainSettings SmoothedChainSettings::getCurrent() const
 {
+    auto current = targets;
 
-    auto highCutCoefficients = makeHighCutFilter(chainSettings, getSampleRate());
+    current.peakFreq = peakFreq.getCurrentValue();
+    current.peakGainInDecibels = peakGainInDecibels.getCurrentValue();
+    current.peakQuality = peakQuality.getCurrentValue();
+    current.lowCutFreq = lowCutFreq.getCurrentValue();
+    current.highCutFreq = highCutFreq.getCurrentValue();
+
+    for (size_t i = 0; i < bands.size(); ++i)
+    {
+        current.bands[i].freq = bands[i].freq.getCurrentValue();
+        current.bands[i].gainInDecibels = bands[i].gainInDecibels.getCurrentValue();
+        current.bands[i].quality = bands[i].quality.getCurrentValue();
+    }
 
-    auto& leftHighCut = leftChain.get<ChainPositions::HighCut>();
-    auto& rightHighCut = rightChain.get<ChainPositions::HighCut>();
+    return current;
+}
 
-    updateCutFilter(rightHighCut, highCutCoefficients, chainSettings.highCutSlope);
-    updateCutFilter(leftHighCut, highCutCoefficients, chainSettings.highCutSlope);
+void SmoothedChainSettings::skipCutSmoothing()
+{
+    lowCutFreq.setCurrentAndTargetValue(targets.lowCutFreq);
+    highCutFreq.setCurrentAndTargetValue(targets.highCutFreq);
 }
 
-void SimpleEQAudioProcessor::updateFilters()
+void SmoothedChainSettings::skipSmoothing()
 {
-    auto chainSettings = getChainSettings(apvts);
+    skipCutSmoothing();
+
+    peakFreq.setCurrentAndTargetValue(targets.peakFreq);
+    peakGainInDecibels.setCurrentAndTargetValue(targets.peakGainInDecibels);
+    peakQuality.setCurrentAndTargetValue(targets.peakQuality);
 
-    updateLowCutFilters(chainSettings);
-    updatePeakFilter(chainSettings);
-    updateHighCutFilters(chainSettings);
-    
+    for (size_t i = 0; i < bands.size(); ++i)
+        bands[i].setCurrentAndTargetValues(targets.bands[i]);
 }
 
-// // BPR - Here we declare the parameter layout 
-juce::AudioProcessorValueTreeState::ParameterLayout  
-    SimpleEQAudioProcessor::createParameterLayout()
+void designLowCutCoefficients(const ChainSettings& chainSettings, double sampleRate, ChainCoefficients& chainCoefficients, CutFilterCache* cache)
+{
+    auto design = [&](double frequency, CutFilterDesign& result)
+    {
+        // Parked: identity sections, which the cascade leaves out
+        if (isLowCutParked(frequency))
+        {
+            result = {};
+            return;
+        }
+
+        BiquadDesign::makeButterworthHighPass(sampleRate, frequency, (chainSettings.lowCutSlope + 1) * 2, result.sections);
+
+        result.parallel = makeParallelSections(result.sections, chainSettings.lowCutSlope + 1, sampleRate);
+    };
+
+    CutFilterDesign lowCut;
 
+    if (cache != nullptr)
+        cache->getOrDesign(CutFilterCache::Type::highPass, chainSettings.lowCutFreq, (chainSettings.lowCutSlope + 1) * 2, sampleRate, lowCut, design);
+    else
+        design(chainSettings.lowCutFreq, lowCut);
 
+    chainCoefficients.lowCut = lowCut.sections;
+    chainCoefficients.lowCutParallel = lowCut.parallel;
+    chainCoefficients.lowCutSlope = chainSettings.lowCutSlope;
+    ++chainCoefficients.versions[ChainPositions::LowCut];
+}
+
+void designPeakCoefficients(const ChainSettings& chainSettings, double sampleRate, ChainCoefficients& chainCoefficients)
 {
+    // Designed in double like every other section, each engine rounds it to its own type
+    chainCoefficients.peak = makeBiquadCoefficients(*makePeakFilter<double>(chainSettings, sampleRate));
+    ++chainCoefficients.versions[ChainPositions::Peak];
+}
 
-    // Basically here we add every parameter we need for the plug in
+void designHighCutCoefficients(const ChainSettings& chainSettings, double sampleRate, ChainCoefficients& chainCoefficients, CutFilterCache* cache)
+{
+    auto design = [&](double frequency, CutFilterDesign& result)
+    {
+        if (isHighCutParked(frequency))
+        {
+            result = {};
+            return;
+        }
 
-    juce::AudioProcessorValueTreeState::ParameterLayout layout;
+        BiquadDesign::makeButterworthLowPass(sampleRate, frequency, (chainSettings.highCutSlope + 1) * 2, result.sections);
 
-    layout.add(std::make_unique<juce::AudioParameterFloat>( "LowCut Freq",
-                                                            "LowCut Freq",
-                                                             juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f),
-                                                             20.f));
+        result.parallel = makeParallelSections(result.sections, chainSettings.highCutSlope + 1, sampleRate);
+    };
 
-    layout.add(std::make_unique<juce::AudioParameterFloat>( "HighCut Freq",
-                                                            "HighCut Freq",
-                                                            juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f),
-                                                            20000.f));
+    CutFilterDesign highCut;
 
-    layout.add(std::make_unique<juce::AudioParameterFloat>( "PeakCut Freq",
-                                                            "PeakCut Freq",
-                                                            juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f),
-                                                            750.f));
+    if (cache != nullptr)
+        cache->getOrDesign(CutFilterCache::Type::lowPass, chainSettings.highCutFreq, (chainSettings.highCutSlope + 1) * 2, sampleRate, highCut, design);
+    else
+        design(chainSettings.highCutFreq, highCut);
 
-    layout.add(std::make_unique<juce::AudioParameterFloat>( "Peak Gain",
-                                                            "Peak Gain",
-                                                            juce::NormalisableRange<float>(-24.f, 24.f, 0.5f, 1.f),
-                                                            0.f));
+    chainCoefficients.highCut = highCut.sections;
+    chainCoefficients.highCutParallel = highCut.parallel;
+    chainCoefficients.highCutSlope = chainSettings.highCutSlope;
+    ++chainCoefficients.versions[ChainPositions::HighCut];
+}
 
-    layout.add(std::make_unique<juce::AudioParameterFloat>( "Peak Quality",
-                                                            "Peak Quality",
-                                                            juce::NormalisableRange<float>(0.1f, 10.f, 0.05f, 1.f),
-                                                            1.f));
+void designLowCutSections(const ChainSettings& chainSettings, double sampleRate, std::array<BiquadCoefficients, 4>& sections)
+{
+    if (isLowCutParked(chainSettings.lowCutFreq))
+        sections.fill({});
+    else
+        BiquadDesign::makeButterworthHighPass(sampleRate, chainSettings.lowCutFreq, (chainSettings.lowCutSlope + 1) * 2, sections);
+}
 
-    layout.add(std::make_unique<juce::AudioParameterFloat>("Master Volume",
-                                                           "Master Volume",
-                                                           juce::NormalisableRange<float>(0.0f, 100.0f, 0.5f, 1.f),
-                                                           100));
+void designHighCutSections(const ChainSettings& chainSettings, double sampleRate, std::array<BiquadCoefficients, 4>& sections)
+{
+    if (isHighCutParked(chainSettings.highCutFreq))
+        sections.fill({});
+    else
+        BiquadDesign::makeButterworthLowPass(sampleRate, chainSettings.highCutFreq, (chainSettings.highCutSlope + 1) * 2, sections);
+}
 
-    // Making the choice array
+BiquadCoefficients designPeakSection(const ChainSettings& chainSettings, double sampleRate)
+{
+    return BiquadDesign::makePeak(sampleRate,
+        chainSettings.peakFreq,
+        chainSettings.peakQuality,
+        juce::Decibels::decibelsToGain(chainSettings.peakGainInDecibels));
+}
 
-    juce::StringArray stringArray;
-    int stringArraySize{ 4 };
-    for (size_t i = 0; i < stringArraySize; i++)
+BiquadCoefficients designBandSection(const BandSettings& bandSettings, double sampleRate)
+{
+    const auto gainFactor = juce::Decibels::decibelsToGain(bandSettings.gainInDecibels);
+
+    switch (bandSettings.type)
     {
-        juce::String str;
-        str << (12 + i * 12);
-        str << "dB/Oct";
-        stringArray.add(str);
+        case Band_Peak:      return BiquadDesign::makePeak(sampleRate, bandSettings.freq, bandSettings.quality, gainFactor);
+        case Band_LowShelf:  return BiquadDesign::makeLowShelf(sampleRate, bandSettings.freq, bandSettings.quality, gainFactor);
+        case Band_HighShelf: return BiquadDesign::makeHighShelf(sampleRate, bandSettings.freq, bandSettings.quality, gainFactor);
+        case Band_Notch:     return BiquadDesign::makeNotch(sampleRate, bandSettings.freq, bandSettings.quality);
+        case Band_LowCut:    return BiquadDesign::makeHighPass(sampleRate, bandSettings.freq, bandSettings.quality);
+        case Band_HighCut:   return BiquadDesign::makeLowPass(sampleRate, bandSettings.freq, bandSettings.quality);
+        case Band_Off:
+        default:             return {};
     }
+}
 
-    layout.add(std::make_unique<juce::AudioParameterChoice>("LowCut Slope", "LowCutSlope", stringArray, 0));
+void designParametricBandCoefficients(const ChainSettings& chainSettings, double sampleRate, ChainCoefficients& chainCoefficients)
+{
+    for (size_t i = 0; i < chainSettings.bands.size(); ++i)
+    {
+        const auto& band = chainSettings.bands[i];
 
-    layout.add(std::make_unique<juce::AudioParameterChoice>("HighCut Slope","HighCutSlope", stringArray, 0));
+        chainCoefficients.bands[i] = designBandSection(band, sampleRate);
+        chainCoefficients.bandsActive[i] = band.type != Band_Off;
+    }
+
+    ++chainCoefficients.bandsVersion;
+}
+
+ChainCoefficients makeChainCoefficients(const ChainSettings& chainSettings, double sampleRate)
+{
+    ChainCoefficients chainCoefficients;
+
+    designLowCutCoefficients(chainSettings, sampleRate, chainCoefficients);
+    designPeakCoefficients(chainSettings, sampleRate, chainCoefficients);
+    designHighCutCoefficients(chainSettings, sampleRate, chainCoefficients);
+    designParametricBandCoefficients(chainSettings, sampleRate, chainCoefficients);
+
+    return chainCoefficients;
+}
+
+// Sections the cascade runs for these coefficients, in cascade order
+static int getActiveSections(const ChainCoefficients& chainCoefficients,
+                             std::array<BiquadCoefficients, BiquadCascade::maxSections>& sections)
+{
+    int numSections = 0;
+
+    for (int i = 0; i <= chainCoefficients.lowCutSlope; ++i)
+        sections[(size_t)numSections++] = chainCoefficients.lowCut[(size_t)i];
+
+    sections[(size_t)numSections++] = chainCoefficients.peak;
+
+    for (int i = 0; i <= chainCoefficients.highCutSlope; ++i)
+        sections[(size_t)numSections++] = chainCoefficients.highCut[(size_t)i];
+
+    for (size_t i = 0; i < chainCoefficients.bands.size(); ++i)
+        if (chainCoefficients.bandsActive[i])
+            sections[(size_t)numSections++] = chainCoefficients.bands[i];
+
+    return numSections;
+}
+
+void getChainMagnitudes(const ChainCoefficients& chainCoefficients, std::vector<double>& magnitudes)
+{
+    std::array<BiquadCoefficients, BiquadCascade::maxSections> sections;
+    const auto numSections = getActiveSections(chainCoefficients, sections);
+
+    const auto lastBin = (double)juce::jmax(1, (int)magnitudes.size() - 1);
+
+    for (size_t k = 0; k < magnitudes.size(); ++k)
+    {
+        const auto w = std::polar(1.0, -juce::MathConstants<double>::pi * (double)k / lastBin);
+        auto magnitude = 1.0;
+
+        for (int s = 0; s < numSections; ++s)
+            magnitude *= BiquadDesign::getMagnitude(sections[(size_t)s], w);
+
+        magnitudes[k] = magnitude;
+    }
+}
+
+double getChainTailLength(const ChainCoefficients& chainCoefficients, double decayFactor, double maxLength)
+{
+    std::array<BiquadCoefficients, BiquadCascade::maxSections> sections;
+    const auto numSections = getActiveSections(chainCoefficients, sections);
+
+    // Each section stretches the response of the ones before it by its own decay, summing
+    // them is on the safe side
+    auto tailLength = 0.0;
+
+    for (int s = 0; s < numSections; ++s)
+        if (! sections[(size_t)s].isTransparent())
+            tailLength += BiquadDesign::getDecayLength(sections[(size_t)s], decayFactor, maxLength);
+
+    return juce::jmin(tailLength, maxLength);
+}
+
+// BPR -> same fall-through idea as updateCutFilter: a steeper slope just enables more sections.
+// Bypassing is all or nothing across the lanes, so when a single lane is updated its unused
+// sections stay enabled and pass the signal through instead.
+
+template<typename SampleType>
+void updateCutSections(BasicBiquadCascade<SampleType>& cascade,
+    int firstSection,
+    const std::array<BiquadCoefficients, 4>& coefficients,
+    const Slope& slope,
+    int lane)
+{
+    for (int i = 0; i < 4; ++i)
+    {
+        if (lane == BiquadCascade::allLanes)
+        {
+            cascade.setCoefficients(firstSection + i, coefficients[i]);
+            cascade.setBypassed(firstSection + i, i > slope);
+        }
+        else
+        {
+            cascade.setCoefficients(firstSection + i, i > slope ? BiquadCoefficients {} : coefficients[i], lane);
+            cascade.setBypassed(firstSection + i, false);
+        }
+    }
+}
+
+template<typename SampleType>
+void bypassCutSections(BasicBiquadCascade<SampleType>& cascade, int firstSection)
+{
+    for (int i = 0; i < 4; ++i)
+        cascade.setBypassed(firstSection + i, true);
+}
+
+// BPR -> refactored updatePeakFilterFunction
+
+template<typename SampleType>
+void SimpleEQAudioProcessor::updatePeakFilter(const ChainCoefficients& chainCoefficients, int lane)
+{
+    auto& filterChain = getEngines<SampleType>().filterChain;
+
+    filterChain.setCoefficients(CascadeSections::PeakSection, chainCoefficients.peak, lane);
+    filterChain.setBypassed(CascadeSections::PeakSection, false);
+}
+
+// BPR -> the parallel form is only used when the designer could verify it against the cascade
+
+template<typename SampleType>
+void SimpleEQAudioProcessor::updateLowCutFilters(const ChainCoefficients& chainCoefficients, int lane)
+{
+    auto& e = getEngines<SampleType>();
+    const auto useParallel = parallelCutsApplied && chainCoefficients.lowCutParallel.isValid;
+
+    if (useParallel)
+    {
+        bypassCutSections(e.filterChain, CascadeSections::LowCutSections);
+        e.lowCutParallel.setSections(chainCoefficients.lowCutParallel);
+    }
+    else
+    {
+        updateCutSections(e.filterChain, CascadeSections::LowCutSections, chainCoefficients.lowCut, chainCoefficients.lowCutSlope, lane);
+    }
+
+    e.lowCutParallel.setActive(useParallel);
+}
+
+template<typename SampleType>
+void SimpleEQAudioProcessor::updateHighCutFilters(const ChainCoefficients& chainCoefficients, int lane)
+{
+    auto& e = getEngines<SampleType>();
+    const auto useParallel = parallelCutsApplied && chainCoefficients.highCutParallel.isValid;
+
+    if (useParallel)
+    {
+        bypassCutSections(e.filterChain, CascadeSections::HighCutSections);
+        e.highCutParallel.setSections(chainCoefficients.highCutParallel);
+    }
+    else
+    {
+        updateCutSections(e.filterChain, CascadeSections::HighCutSections, chainCoefficients.highCut, chainCoefficients.highCutSlope, lane);
+    }
+
+    e.highCutParallel.setActive(useParallel);
+}
+
+// BPR -> the parametric bands are shared by every lane, whatever the stereo mode. A band that
+// is ramping gets its designs from the smoothing instead, so the published set only counts as
+// applied once none of them ramps any more.
+
+template<typename SampleType>
+void SimpleEQAudioProcessor::updateParametricBands()
+{
+    const auto& chainCoefficients = mainPath.published.getReadBuffer();
+
+    if (chainCoefficients.bandsVersion == mainPath.appliedBandsVersion)
+        return;
+
+    auto& filterChain = getEngines<SampleType>().filterChain;
+    auto allApplied = true;
+
+    for (int i = 0; i < BiquadCascade::maxParametricBands; ++i)
+    {
+        if (mainPath.smoothed.isBandSmoothing(i))
+        {
+            allApplied = false;
+            continue;
+        }
+
+        const auto index = CascadeSections::ParametricBandSections + i;
+        const auto& coefficients = chainCoefficients.bands[(size_t)i];
+        const auto bypassed = ! chainCoefficients.bandsActive[(size_t)i];
+
+        if (coefficients != filterChain.getCoefficients(index))
+        {
+            // What can't ramp, e.g. a running band switching type, crossfades instead of stepping
+            if (! bypassed && ! filterChain.isBypassed(index))
+                filterChain.beginCrossfade();
+
+            filterChain.setCoefficients(index, coefficients);
+        }
+
+        filterChain.setBypassed(index, bypassed);
+    }
+
+    if (allApplied)
+        mainPath.appliedBandsVersion = chainCoefficients.bandsVersion;
+}
+
+// Redesigns the bands that were ramping before the smoothing moved on to bands
+
+template<typename SampleType>
+void SimpleEQAudioProcessor::updateSmoothedBands(const std::array<bool, BiquadCascade::maxParametricBands>& wereSmoothing,
+                                                 const ParametricBandSettings& bands)
+{
+    auto& filterChain = getEngines<SampleType>().filterChain;
+    const auto sampleRate = getSampleRate();
+
+    for (int i = 0; i < BiquadCascade::maxParametricBands; ++i)
+        if (wereSmoothing[(size_t)i])
+            filterChain.setCoefficients(CascadeSections::ParametricBandSections + i, designBandSection(bands[(size_t)i], sampleRate));
+}
+
+template<typename SampleType>
+void SimpleEQAudioProcessor::updateSmoothedBands(int numSamples)
+{
+    std::array<bool, BiquadCascade::maxParametricBands> wereSmoothing;
+
+    for (int i = 0; i < BiquadCascade::maxParametricBands; ++i)
+        wereSmoothing[(size_t)i] = mainPath.smoothed.isBandSmoothing(i);
+
+    updateSmoothedBands<SampleType>(wereSmoothing, mainPath.smoothed.advanceBands(numSamples));
+}
+
+bool SimpleEQAudioProcessor::wantsMidSide() const
+{
+    return stereoModeParam->load() > 0.5f && getTotalNumOutputChannels() == 2;
+}
+
+bool SimpleEQAudioProcessor::wantsParallelCuts() const
+{
+    return cutFilterFormParam->load() > 0.5f && ! wantsMidSide();
+}
+
+template<typename SampleType>
+void SimpleEQAudioProcessor::updateFilters(bool reapplyAll)
+{
+    // Audio thread side: no design work here, only a copy of the newest published set
+
+    const auto useMidSide = wantsMidSide();
+    const auto useParallelCuts = wantsParallelCuts();
+
+    const auto midSideChanged = useMidSide != midSideApplied;
+    const auto formChanged = reapplyAll || midSideChanged || useParallelCuts != parallelCutsApplied;
+
+    if (midSideChanged)
+    {
+        // The state belongs to the other representation, start over from silence
+        auto& filterChain = getEngines<SampleType>().filterChain;
+
+        filterChain.setMidSide(useMidSide);
+        filterChain.reset();
+    }
+
+    parallelCutsApplied = useParallelCuts;
+    midSideApplied = useMidSide;
+
+    updateFilters<SampleType>(mainPath, getMainLane(), formChanged);
+
+    if (midSideApplied)
+        updateFilters<SampleType>(sidePath, sideLane, formChanged);
+
+    updateParametricBands<SampleType>();
+}
+
+template<typename SampleType>
+void SimpleEQAudioProcessor::updateFilters(FilterPath& path, int lane, bool formChanged)
+{
+    path.published.pull();
+
+    const auto& chainCoefficients = path.published.getReadBuffer();
+    const auto& versions = chainCoefficients.versions;
+    auto& appliedVersions = path.appliedVersions;
+
+    // Only the bands that were actually redesigned (or switched form) get touched. A band
+    // that is ramping keeps its smoothed coefficients, the published ones are picked up
+    // once its ramp is over.
+
+    if (! path.smoothed.isLowCutSmoothing()
+        && (formChanged || versions[ChainPositions::LowCut] != appliedVersions[ChainPositions::LowCut]))
+    {
+        updateLowCutFilters<SampleType>(chainCoefficients, lane);
+        appliedVersions[ChainPositions::LowCut] = versions[ChainPositions::LowCut];
+    }
+
+    if (! path.smoothed.isPeakSmoothing()
+        && (formChanged || versions[ChainPositions::Peak] != appliedVersions[ChainPositions::Peak]))
+    {
+        updatePeakFilter<SampleType>(chainCoefficients, lane);
+        appliedVersions[ChainPositions::Peak] = versions[ChainPositions::Peak];
+    }
+
+    if (! path.smoothed.isHighCutSmoothing()
+        && (formChanged || versions[ChainPositions::HighCut] != appliedVersions[ChainPositions::HighCut]))
+    {
+        updateHighCutFilters<SampleType>(chainCoefficients, lane);
+        appliedVersions[ChainPositions::HighCut] = versions[ChainPositions::HighCut];
+    }
+}
+
+bool SimpleEQAudioProcessor::isSmoothing() const
+{
+    return mainPath.smoothed.isSmoothing() || (midSideApplied && sidePath.smoothed.isSmoothing());
+}
+
+template<typename SampleType>
+bool SimpleEQAudioProcessor::isTransparent() const
+{
+    const auto& e = getEngines<SampleType>();
+
+    return ! isSmoothing() && e.filterChain.isTransparent() && ! e.lowCutParallel.isActive() && ! e.highCutParallel.isActive()
+        && ! masterGain.isSmoothing() && masterGain.getTargetValue() == 1.f;
+}
+
+template<typename SampleType>
+void SimpleEQAudioProcessor::updateSmoothedFilters(int numSamples)
+{
+    updateSmoothedFilters<SampleType>(mainPath, getMainLane(), numSamples);
+
+    if (midSideApplied)
+        updateSmoothedFilters<SampleType>(sidePath, sideLane, numSamples);
+}
+
+template<typename SampleType>
+void SimpleEQAudioProcessor::updateSmoothedFilters(FilterPath& path, int lane, int numSamples)
+{
+    auto& filterChain = getEngines<SampleType>().filterChain;
+    auto& smoothedSettings = path.smoothed;
+
+    // Which bands were ramping has to be known before advancing, so the block that
+    // reaches the target still gets its final design
+    const auto lowCutSmoothing = smoothedSettings.isLowCutSmoothing();
+    const auto peakSmoothing = smoothedSettings.isPeakSmoothing();
+    const auto highCutSmoothing = smoothedSettings.isHighCutSmoothing();
+
+    std::array<bool, BiquadCascade::maxParametricBands> bandsSmoothing;
+
+    for (int i = 0; i < BiquadCascade::maxParametricBands; ++i)
+        bandsSmoothing[(size_t)i] = smoothedSettings.isBandSmoothing(i);
+
+    const auto current = smoothedSettings.advance(numSamples);
+    const auto sampleRate = getSampleRate();
+
+    // The bands are shared by the lanes and follow the main path only
+    if (&path == &mainPath)
+        updateSmoothedBands<SampleType>(bandsSmoothing, current.bands);
+
+    if (lowCutSmoothing)
+    {
+        std::array<BiquadCoefficients, 4> sections;
+        designLowCutSections(current, sampleRate, sections);
+        updateCutSections(filterChain, CascadeSections::LowCutSections, sections, current.lowCutSlope, lane);
+    }
+
+    if (peakSmoothing)
+    {
+        filterChain.setCoefficients(CascadeSections::PeakSection, designPeakSection(current, sampleRate), lane);
+        filterChain.setBypassed(CascadeSections::PeakSection, false);
+    }
+
+    if (highCutSmoothing)
+    {
+        std::array<BiquadCoefficients, 4> sections;
+        designHighCutSections(current, sampleRate, sections);
+        updateCutSections(filterChain, CascadeSections::HighCutSections, sections, current.highCutSlope, lane);
+    }
+}
+
+// BPR -> SVF engine, no worker thread involved: the coefficients are cheap enough to compute
+// right here, per block when the settings jump and per sample while they ramp
+
+bool SimpleEQAudioProcessor::shouldUseSvfEngine() const
+{
+    return filterEngineParam->load() > 0.5f && ! wantsMidSide() && ! wantsParallelCuts();
+}
+
+template<typename SampleType>
+void SimpleEQAudioProcessor::updateSvfFilters(const ChainSettings& chainSettings, bool lowCut, bool peak, bool highCut)
+{
+    if (lowCut)
+        updateSvfLowCut<SampleType>(chainSettings.lowCutFreq, chainSettings.lowCutSlope);
+
+    if (peak)
+        updateSvfPeak<SampleType>(chainSettings.peakFreq, chainSettings.peakQuality, chainSettings.peakGainInDecibels);
+
+    if (highCut)
+        updateSvfHighCut<SampleType>(chainSettings.highCutFreq, chainSettings.highCutSlope);
+
+    svfSettings = chainSettings;
+}
+
+// A parked cut has no stages, same as the cascade leaving out its identity sections. The stage
+// count only changes on a slope change or on parking, everything else is a new cutoff.
+
+template<typename SampleType>
+void SimpleEQAudioProcessor::updateSvfLowCut(float frequency, Slope slope)
+{
+    auto& svfChain = getEngines<SampleType>().svfChain;
+    const auto numStages = isLowCutParked(frequency) ? 0 : slope + 1;
+
+    if (numStages != svfLowCutStages)
+    {
+        svfChain.setCutStages(CascadeSections::LowCutSections, numStages, true);
+        svfLowCutStages = numStages;
+    }
+
+    svfChain.setCutFrequency(CascadeSections::LowCutSections, frequency);
+}
+
+template<typename SampleType>
+void SimpleEQAudioProcessor::updateSvfHighCut(float frequency, Slope slope)
+{
+    auto& svfChain = getEngines<SampleType>().svfChain;
+    const auto numStages = isHighCutParked(frequency) ? 0 : slope + 1;
+
+    if (numStages != svfHighCutStages)
+    {
+        svfChain.setCutStages(CascadeSections::HighCutSections, numStages, false);
+        svfHighCutStages = numStages;
+    }
+
+    svfChain.setCutFrequency(CascadeSections::HighCutSections, frequency);
+}
+
+template<typename SampleType>
+void SimpleEQAudioProcessor::updateSvfPeak(float frequency, float quality, float gainInDecibels)
+{
+    getEngines<SampleType>().svfChain.setPeak(CascadeSections::PeakSection, frequency, quality,
+                                              juce::Decibels::decibelsToGain(gainInDecibels));
+}
+
+template<typename SampleType>
+void SimpleEQAudioProcessor::processSvf(const juce::dsp::AudioBlock<SampleType>& block)
+{
+    auto& e = getEngines<SampleType>();
+    auto& svfChain = e.svfChain;
+
+    if (! svfEngineApplied)
+    {
+        // filterChain keeps only the parametric bands, crossfading out of the cuts and the peak.
+        // Until that is over the sections being faded out run on the input, the SVF chain's
+        // output only goes into the bands coming in.
+        if (midSideApplied)
+        {
+            e.filterChain.setMidSide(false);
+            e.filterChain.reset();
+            midSideApplied = false;
+        }
+
+        e.filterChain.beginCrossfade();
+        svfHandover = true;
+
+        for (int i = 0; i < CascadeSections::ParametricBandSections; ++i)
+            e.filterChain.setBypassed(i, true);
+
+        svfChain.reset();
+        svfLowCutStages = svfHighCutStages = -1;
+        updateSvfFilters<SampleType>(mainPath.smoothed.getCurrent(), true, true, true);
+        svfEngineApplied = true;
+    }
+
+    mainPath.published.pull();
+    updateParametricBands<SampleType>();
+
+    auto outgoingInput = block;
+
+    if (svfHandover && e.filterChain.isCrossfading())
+        outgoingInput = getSvfHandoverBlock(block);
+    else
+        svfHandover = false;
+
+    // Ramping bands are redesigned every smoothingBlockSize samples, like the cascade engine does
+    const auto numSamples = (int)block.getNumSamples();
+    const auto partSize = mainPath.smoothed.isBandsSmoothing() ? SmoothedChainSettings::smoothingBlockSize : numSamples;
+
+    for (int start = 0; start < numSamples; start += partSize)
+    {
+        const auto num = juce::jmin(partSize, numSamples - start);
+        const auto part = block.getSubBlock((size_t)start, (size_t)num);
+        const auto outgoingPart = outgoingInput.getSubBlock((size_t)start, (size_t)num);
+
+        if (mainPath.smoothed.isBandsSmoothing())
+            updateSmoothedBands<SampleType>(num);
+
+        processSvfStages(part);
+
+        // The bands, and the master gain on their way out
+        const auto gainStart = masterGain.getCurrentValue();
+        const auto gainEnd = masterGain.skip(num);
+
+        e.filterChain.process(part, outgoingPart, gainStart, gainEnd);
+    }
+}
+
+template<typename SampleType>
+void SimpleEQAudioProcessor::processSvfStages(const juce::dsp::AudioBlock<SampleType>& block)
+{
+    auto& svfChain = getEngines<SampleType>().svfChain;
+
+    if (! mainPath.smoothed.isMonoChainSmoothing())
+    {
+        const auto current = mainPath.smoothed.getCurrent();
+
+        updateSvfFilters<SampleType>(current,
+                         ! current.hasSameLowCut(svfSettings),
+                         ! current.hasSamePeak(svfSettings),
+                         ! current.hasSameHighCut(svfSettings));
+
+        svfChain.process(block);
+        return;
+    }
+
+    // Ramping: one processing loop, and before every sample only the ramps that are moving
+    // take a step and retune their stages in place. Bands that aren't ramping can still have
+    // jumped (e.g. a slope change), those are applied once up front.
+    auto& smoothed = mainPath.smoothed;
+    const auto& targets = smoothed.getTargets();
+
+    const auto lowCutSmoothing = smoothed.isLowCutSmoothing();
+    const auto peakSmoothing = smoothed.isPeakSmoothing();
+    const auto highCutSmoothing = smoothed.isHighCutSmoothing();
+
+    updateSvfFilters<SampleType>(targets,
+                     ! lowCutSmoothing && ! targets.hasSameLowCut(svfSettings),
+                     ! peakSmoothing && ! targets.hasSamePeak(svfSettings),
+                     ! highCutSmoothing && ! targets.hasSameHighCut(svfSettings));
+
+    svfChain.process(block, [&]
+    {
+        if (lowCutSmoothing)
+            updateSvfLowCut<SampleType>(smoothed.getNextLowCutFreq(), targets.lowCutSlope);
+
+        if (peakSmoothing)
+            updateSvfPeak<SampleType>(smoothed.getNextPeakFreq(), smoothed.getNextPeakQuality(), smoothed.getNextPeakGainInDecibels());
+
+        if (highCutSmoothing)
+            updateSvfHighCut<SampleType>(smoothed.getNextHighCutFreq(), targets.highCutSlope);
+    });
+
+    svfSettings = smoothed.getCurrent();
+}
+
+// BPR -> swaps a new linear phase setup in and starts the handover to it, then hands the current
+// convolver the newest kernel. Swapping only moves the convolvers' storage around, the old setup
+// goes back to the message thread through the triple buffer and is freed there.
+
+template<typename SampleType>
+void SimpleEQAudioProcessor::pullLinearPhaseUpdates()
+{
+    // A setup that arrives during a handover waits in the triple buffer, newer ones replace it
+    const auto installed = handoverRemaining == 0 && linearPhaseSetups.pull();
+
+    if (installed)
+    {
+        std::swap(linearPhaseOutgoing, linearPhaseCurrent);
+        std::swap(linearPhaseCurrent, linearPhaseSetups.getReadBuffer());
+
+        // The minimum phase engines have been idle, their state is stale
+        if (! linearPhaseCurrent.enabled && linearPhaseOutgoing.enabled)
+            resetEngines<SampleType>();
+
+        handoverFadeLength = juce::jmax(1, juce::roundToInt(linearPhaseFadeSeconds * getSampleRate()));
+        handoverRemaining = handoverFadeLength + (linearPhaseCurrent.enabled ? linearPhaseCurrent.latency : 0);
+    }
+
+    if (! linearPhaseCurrent.enabled)
+        return;
+
+    // A kernel that arrives during a crossfade waits as well. A new convolver also gets offered
+    // the kernel pulled before it came in, setKernel drops it if it is stale.
+    auto& current = linearPhaseCurrent;
+    const auto canAcceptKernels = current.convolver.canAcceptKernel()
+                               && (! current.midSide || current.sideConvolver.canAcceptKernel());
+
+    if (canAcceptKernels && (linearPhaseKernels.pull() || installed))
+    {
+        const auto& kernels = linearPhaseKernels.getReadBuffer();
+
+        current.convolver.setKernel(kernels.main);
+
+        if (current.midSide)
+            current.sideConvolver.setKernel(kernels.side);
+    }
+}
+
+template<typename SampleType>
+void SimpleEQAudioProcessor::processChain(const juce::dsp::AudioBlock<SampleType>& block,
+                                          const juce::dsp::AudioBlock<SampleType>& outgoingInput)
+{
+    auto& e = getEngines<SampleType>();
+
+    // The parallel high cut is linear, so the gain can already go in with the cascade before it
+    const auto gainStart = masterGain.getCurrentValue();
+    const auto gainEnd = masterGain.skip((int)block.getNumSamples());
+
+    e.lowCutParallel.process(block);
+    e.filterChain.process(block, outgoingInput, gainStart, gainEnd);
+    e.highCutParallel.process(block);
+}
+
+template<typename SampleType>
+void SimpleEQAudioProcessor::applyMasterGain(juce::AudioBuffer<SampleType>& buffer)
+{
+    const auto numSamples = buffer.getNumSamples();
+    const auto gainStart = masterGain.getCurrentValue();
+    const auto gainEnd = masterGain.skip(numSamples);
+
+    if (gainStart != 1.f || gainEnd != 1.f)
+        buffer.applyGainRamp(0, numSamples, (SampleType)gainStart, (SampleType)gainEnd);
+}
+
+// BPR -> background side of the coefficient pipeline
+
+void SimpleEQAudioProcessor::designCoefficients(bool forceRedesign)
+{
+    auto sampleRate = designSampleRate.load();
+
+    if (sampleRate <= 0.0)
+        return;
+
+    // prepareToPlay and the design thread can both get here, the triple buffer only allows one writer
+    const juce::ScopedLock sl(designLock);
+
+    designedEpoch = settingsEpoch.load();
+
+    forceRedesign = forceRedesign || sampleRate != designedSampleRate;
+
+    // The side path is kept up to date as well, so switching to mid/side never waits on it
+    const auto mainChanged = designCoefficients(mainPath, sampleRate, forceRedesign);
+    const auto sideChanged = designCoefficients(sidePath, sampleRate, forceRedesign);
+
+    if (linearPhaseDesignEnabled && (mainChanged || (linearPhaseMidSide && sideChanged)))
+        designLinearPhaseKernel();
+
+    designedSampleRate = sampleRate;
+
+    updateTailLength(sampleRate);
+}
+
+bool SimpleEQAudioProcessor::designCoefficients(FilterPath& path, double sampleRate, bool forceRedesign)
+{
+    auto chainSettings = path.parameters.load();
+    auto& designedSettings = path.designedSettings;
+    auto& designedCoefficients = path.designedCoefficients;
+
+    bool changed = false;
+
+    if (forceRedesign || ! chainSettings.hasSameLowCut(designedSettings))
+    {
+        designLowCutCoefficients(chainSettings, sampleRate, designedCoefficients, &cutFilterCache.getObject());
+        changed = true;
+    }
+
+    if (forceRedesign || ! chainSettings.hasSamePeak(designedSettings))
+    {
+        designPeakCoefficients(chainSettings, sampleRate, designedCoefficients);
+        changed = true;
+    }
+
+    if (forceRedesign || ! chainSettings.hasSameHighCut(designedSettings))
+    {
+        designHighCutCoefficients(chainSettings, sampleRate, designedCoefficients, &cutFilterCache.getObject());
+        changed = true;
+    }
+
+    if (forceRedesign || ! chainSettings.hasSameBands(designedSettings))
+    {
+        designParametricBandCoefficients(chainSettings, sampleRate, designedCoefficients);
+        changed = true;
+    }
+
+    designedSettings = chainSettings;
+
+    // Nothing the filters depend on moved (e.g. a host re-sending the same value)
+    if (! changed)
+        return false;
+
+    path.published.getWriteBuffer() = designedCoefficients;
+    path.published.publish();
+    return true;
+}
+
+// BPR -> the whole main path as one FIR, the magnitudes come from the coefficients just designed
+
+void SimpleEQAudioProcessor::designLinearPhaseKernel()
+{
+    auto& kernels = linearPhaseKernels.getWriteBuffer();
+
+    getChainMagnitudes(mainPath.designedCoefficients, linearPhaseDesigner.getMagnitudes());
+    linearPhaseDesigner.design(kernels.main);
+
+    if (linearPhaseMidSide)
+    {
+        // The side path has no bands of its own, the biquad engine runs the main bands on both lanes
+        auto sideCoefficients = sidePath.designedCoefficients;
+        sideCoefficients.bands = mainPath.designedCoefficients.bands;
+        sideCoefficients.bandsActive = mainPath.designedCoefficients.bandsActive;
+
+        getChainMagnitudes(sideCoefficients, linearPhaseDesigner.getMagnitudes());
+        linearPhaseDesigner.design(kernels.side);
+    }
+
+    linearPhaseKernels.publish();
+}
+
+// BPR -> the FIR length follows the sample rate and the partition size is the latency / CPU
+// trade off. Called from prepareToPlay, and from handleAsyncUpdate while the host keeps playing.
+// Everything that allocates happens here, the audio thread only swaps the finished setup in.
+
+void SimpleEQAudioProcessor::configureLinearPhase(double sampleRate, int samplesPerBlock, int numChannels, bool forceSetup)
+{
+    const auto useLinearPhase = apvts.getRawParameterValue("Phase Mode")->load() > 0.5f;
+    const auto firLength = LinearPhaseDesigner::getFirLength(sampleRate);
+    auto partitionSize = juce::jmin(firLength, 256 << (int)apvts.getRawParameterValue("Linear Phase Partition")->load());
+    auto tailPartitionSize = 0;
+
+    // Non uniform: the head partition follows the host block size, which sets the latency, and
+    // the partition choice becomes the size of the tail partitions
+    if (apvts.getRawParameterValue("Linear Phase Partitioning")->load() > 0.5f)
+    {
+        const auto headSize = juce::jlimit(32, 512, juce::nextPowerOfTwo(samplesPerBlock));
+        const auto tailSize = juce::jmax(partitionSize, headSize * 2);
+
+        if (LinearPhaseDesigner::getHeadLength(firLength, headSize, tailSize) < firLength)
+        {
+            partitionSize = headSize;
+            tailPartitionSize = tailSize;
+        }
+    }
+
+    // Mid and side get a one channel convolver each
+    const auto midSide = useLinearPhase && wantsMidSide();
+
+    const juce::ScopedLock configuring(linearPhaseLock);
+
+    // Only this function changes the designer, reading it here doesn't need designLock
+    const auto unchanged = useLinearPhase == linearPhaseDesignEnabled && midSide == linearPhaseMidSide
+                        && (! useLinearPhase || (linearPhaseDesigner.getFirLength() == firLength
+                                                 && linearPhaseDesigner.getPartitionSize() == partitionSize
+                                                 && linearPhaseDesigner.getTailPartitionSize() == tailPartitionSize
+                                                 && linearPhaseChannels == numChannels));
+
+    // A partition change while linear phase is off has nothing to set up, and the minimum
+    // phase engines keep running untouched
+    if (unchanged && ! forceSetup)
+        return;
+
+    auto& setup = linearPhaseSetups.getWriteBuffer();
+
+    setup.enabled = useLinearPhase;
+    setup.midSide = midSide;
+    setup.latency = 0;
+
+    if (useLinearPhase)
+    {
+        const auto layout = LinearPhaseDesigner::makeLayout(firLength, partitionSize, tailPartitionSize);
+
+        setup.convolver.prepare(midSide ? 1 : numChannels, layout);
+
+        if (midSide)
+            setup.sideConvolver.prepare(1, layout);
+
+        setup.latency = setup.convolver.getLatencyInSamples() + firLength / 2;
+    }
+
+    {
+        // The kernel for the new layout is published before the setup, so the audio thread
+        // finds it when the setup comes in
+        const juce::ScopedLock sl(designLock);
+
+        linearPhaseDesignEnabled = useLinearPhase;
+        linearPhaseMidSide = midSide;
+        linearPhaseChannels = numChannels;
+
+        if (useLinearPhase)
+        {
+            linearPhaseDesigner.prepare(firLength, partitionSize, tailPartitionSize);
+
+            // Nothing designed at this rate yet in prepareToPlay, which designs everything next
+            if (designedSampleRate == sampleRate)
+                designLinearPhaseKernel();
+        }
+
+        updateTailLength(sampleRate);
+    }
+
+    // The audio thread may take the setup as soon as it is published
+    const auto latency = setup.latency;
+    linearPhaseSetups.publish();
+
+    setLatencySamples(latency);
+}
+
+bool SimpleEQAudioProcessor::isLinearPhaseParameter(const juce::String& parameterID)
+{
+    return parameterID == "Phase Mode" || parameterID == "Linear Phase Partition" || parameterID == "Linear Phase Partitioning"
+        || parameterID == "Stereo Mode";
+}
+
+void SimpleEQAudioProcessor::handleAsyncUpdate()
+{
+    // Not prepared yet, prepareToPlay will pick the settings up
+    if (getSampleRate() <= 0.0)
+        return;
+
+    configureLinearPhase(getSampleRate(), getBlockSize(), juce::jmax(getTotalNumInputChannels(), getTotalNumOutputChannels()));
+}
+
+BiquadProcessingMode SimpleEQAudioProcessor::getProcessingMode() const
+{
+    return processingModeParam->load() > 0.5f ? BiquadProcessingMode::blockStateSpace : BiquadProcessingMode::perSample;
+}
+
+// BPR -> called with designLock held, after a design pass
+
+void SimpleEQAudioProcessor::updateTailLength(double sampleRate)
+{
+    // The FIR is finite, its last tap leaves one partition of buffering after the input stops
+    if (linearPhaseDesignEnabled)
+    {
+        tailSamples.store(linearPhaseDesigner.getFirLength() + linearPhaseDesigner.getPartitionSize());
+        return;
+    }
+
+    // Both paths, whichever ones the stereo mode runs. The SVF engine has the same poles.
+    const auto maxLength = maxTailSeconds * sampleRate;
+    const auto tailLength = juce::jmax(getChainTailLength(mainPath.designedCoefficients, silenceThreshold, maxLength),
+                                       getChainTailLength(sidePath.designedCoefficients, silenceThreshold, maxLength));
+
+    tailSamples.store((int)std::ceil(tailLength));
+}
+
+// BPR -> the state of every engine has decayed below silenceThreshold by the time this returns
+// true, so it is dropped once on the way in and every engine wakes up from silence
+
+template<typename SampleType>
+bool SimpleEQAudioProcessor::isSilentAndDecayed(const juce::AudioBuffer<SampleType>& buffer)
+{
+    const auto numSamples = buffer.getNumSamples();
+    const auto numChannels = juce::jmin(buffer.getNumChannels(), (int)silentSamples.size());
+    const auto tail = (juce::int64)tailSamples.load(std::memory_order_relaxed);
+
+    auto decayed = numChannels > 0;
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        auto& silent = silentSamples[(size_t)ch];
+
+        // What this block outputs rings from the input before it, so the run of silence
+        // has to cover the tail before the block started
+        const auto silentBefore = silent;
+
+        silent = buffer.getMagnitude(ch, 0, numSamples) > (SampleType)silenceThreshold ? 0 : silent + numSamples;
+        decayed = decayed && silent > 0 && silentBefore >= tail;
+    }
+
+    if (! decayed)
+    {
+        sleeping = false;
+        return false;
+    }
+
+    if (! sleeping)
+    {
+        sleeping = true;
+        resetEngines<SampleType>();
+        linearPhaseCurrent.convolver.reset();
+        linearPhaseCurrent.sideConvolver.reset();
+    }
+
+    return true;
+}
+
+template<typename SampleType>
+void SimpleEQAudioProcessor::resetEngines()
+{
+    auto& e = getEngines<SampleType>();
+
+    e.filterChain.reset();
+    e.lowCutParallel.reset();
+    e.highCutParallel.reset();
+    e.svfChain.reset();
+}
+
+void SimpleEQAudioProcessor::parameterChanged(const juce::String& parameterID, float newValue)
+{
+    // Can be called from the audio thread during automation, so only bump the epoch. The
+    // linear phase setup allocates, it gets rebuilt on the message thread.
+    juce::ignoreUnused(newValue);
+    ++settingsEpoch;
+
+    if (isLinearPhaseParameter(parameterID))
+        triggerAsyncUpdate();
+}
+
+int SimpleEQAudioProcessor::useTimeSlice()
+{
+    if (settingsEpoch.load() != designedEpoch)
+        designCoefficients(false);
+
+    // milliseconds until the design thread checks this instance again
+    return 5;
+}
+
+// // BPR - Here we declare the parameter layout 
+juce::AudioProcessorValueTreeState::ParameterLayout  
+    SimpleEQAudioProcessor::createParameterLayout()
+
+
+{
+
+    // Basically here we add every parameter we need for the plug in
+
+    juce::AudioProcessorValueTreeState::ParameterLayout layout;
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>( "LowCut Freq",
+                                                            "LowCut Freq",
+                                                             juce::NormalisableRange<float>(minCutFreq, maxCutFreq, 1.f, 0.25f),
+                                                             20.f));
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>( "HighCut Freq",
+                                                            "HighCut Freq",
+                                                            juce::NormalisableRange<float>(minCutFreq, maxCutFreq, 1.f, 0.25f),
+                                                            20000.f));
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>( "PeakCut Freq",
+                                                            "PeakCut Freq",
+                                                            juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f),
+                                                            750.f));
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>( "Peak Gain",
+                                                            "Peak Gain",
+                                                            juce::NormalisableRange<float>(-24.f, 24.f, 0.5f, 1.f),
+                                                            0.f));
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>( "Peak Quality",
+                                                            "Peak Quality",
+                                                            juce::NormalisableRange<float>(0.1f, 10.f, 0.05f, 1.f),
+                                                            1.f));
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>("Master Volume",
+                                                           "Master Volume",
+                                                           juce::NormalisableRange<float>(0.0f, 100.0f, 0.5f, 1.f),
+                                                           100));
+
+    // Making the choice array
+
+    juce::StringArray stringArray;
+    int stringArraySize{ 4 };
+    for (size_t i = 0; i < stringArraySize; i++)
+    {
+        juce::String str;
+        str << (12 + i * 12);
+        str << "dB/Oct";
+        stringArray.add(str);
+    }
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>("LowCut Slope", "LowCutSlope", stringArray, 0));
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>("HighCut Slope","HighCutSlope", stringArray, 0));
+
+    // Realisation of the cut filters, same response either way
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Cut Filter Form", "CutFilterForm",
+                                                            juce::StringArray { "Cascade", "Parallel" }, 0));
+
+    // How the filter stages are computed, switches from the next block
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Processing Mode", "ProcessingMode",
+                                                            juce::StringArray { "Per Sample", "Block State Space" }, 0));
+
+    // Filter structure for the cuts and the peak, the SVF engine can follow fast automation
+    // sample by sample. Mid/side and the parallel cut form keep the biquad engine.
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Filter Engine", "FilterEngine",
+                                                            juce::StringArray { "Biquad", "SVF" }, 0));
+
+    // Mid/side (biquad engine, stereo buses): the bands above filter the mid, the "Side" ones the side
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Stereo Mode", "StereoMode",
+                                                            juce::StringArray { "Left/Right", "Mid/Side" }, 0));
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>( "Side LowCut Freq",
+                                                            "Side LowCut Freq",
+                                                            juce::NormalisableRange<float>(minCutFreq, maxCutFreq, 1.f, 0.25f),
+                                                            20.f));
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>( "Side HighCut Freq",
+                                                            "Side HighCut Freq",
+                                                            juce::NormalisableRange<float>(minCutFreq, maxCutFreq, 1.f, 0.25f),
+                                                            20000.f));
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>( "Side PeakCut Freq",
+                                                            "Side PeakCut Freq",
+                                                            juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f),
+                                                            750.f));
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>( "Side Peak Gain",
+                                                            "Side Peak Gain",
+                                                            juce::NormalisableRange<float>(-24.f, 24.f, 0.5f, 1.f),
+                                                            0.f));
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>( "Side Peak Quality",
+                                                            "Side Peak Quality",
+                                                            juce::NormalisableRange<float>(0.1f, 10.f, 0.05f, 1.f),
+                                                            1.f));
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Side LowCut Slope", "SideLowCutSlope", stringArray, 0));
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Side HighCut Slope", "SideHighCutSlope", stringArray, 0));
+
+    // Parametric bands, off by default and spread over the spectrum, shared by L/R and M/S
+
+    const juce::StringArray bandTypes { "Off", "Peak", "Low Shelf", "High Shelf", "Notch", "Low Cut", "High Cut" };
+
+    for (int band = 1; band <= BiquadCascade::maxParametricBands; ++band)
+    {
+        const auto name = "Band " + juce::String(band) + " ";
+        const auto defaultFreq = std::round(20.f * std::pow(1000.f, (band - 0.5f) / BiquadCascade::maxParametricBands));
+
+        layout.add(std::make_unique<juce::AudioParameterChoice>(name + "Type", name + "Type", bandTypes, 0));
+
+        layout.add(std::make_unique<juce::AudioParameterFloat>( name + "Freq",
+                                                                name + "Freq",
+                                                                juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f),
+                                                                defaultFreq));
+
+        layout.add(std::make_unique<juce::AudioParameterFloat>( name + "Gain",
+                                                                name + "Gain",
+                                                                juce::NormalisableRange<float>(-24.f, 24.f, 0.5f, 1.f),
+                                                                0.f));
+
+        layout.add(std::make_unique<juce::AudioParameterFloat>( name + "Quality",
+                                                                name + "Quality",
+                                                                juce::NormalisableRange<float>(0.1f, 10.f, 0.05f, 1.f),
+                                                                1.f));
+    }
+
+    // Linear phase: one FIR for the main bands on every channel. Changing these three rebuilds
+    // the FIR engine on the message thread and reports the new latency. A smaller partition
+    // means less latency and more CPU.
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Phase Mode", "PhaseMode",
+                                                            juce::StringArray { "Minimum Phase", "Linear Phase" }, 0));
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Linear Phase Partition", "LinearPhasePartition",
+                                                            juce::StringArray { "256", "512", "1024", "2048" }, 2));
+
+    // Non uniform partitioning keeps the latency near the host block size, the partition
+    // above then sizes the tail partitions that are computed a little every block
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Linear Phase Partitioning", "LinearPhasePartitioning",
+                                                            juce::StringArray { "Uniform", "Non-Uniform" }, 0));
 
 
 
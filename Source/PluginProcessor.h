@@ -10,7 +10,20 @@
 
 #include <JuceHeader.h>
 
+#include "BiquadCascade.h"
+#include "BiquadDesign.h"
+#include "CutFilterCache.h"
+#include "Fifo.h"
+#include "LinearPhaseConvolver.h"
+#include "ParallelCutFilter.h"
+#include "SvfFilter.h"
+
 #include <array>
+#include <atomic>
+#include <cstring>
+#include <tuple>
+#include <utility>
+#include <vector>
 
 
 enum Channel
@@ -19,122 +32,193 @@ enum Channel
     Left  ///effectively 1
 };
 
+// BPR -> lock-free triple buffer: one writer thread publishes whole objects, the audio thread
+// picks up the newest one without locking, allocating or waiting on the writer
+
 template<typename T>
-struct Fifo
+struct TripleBuffer
+{
+    T& getWriteBuffer() { return buffers[writeIndex]; }
+
+    void publish()
+    {
+        auto previous = middle.exchange(writeIndex | freshBit, std::memory_order_acq_rel);
+        writeIndex = previous & indexMask;
+    }
+
+    bool pull()
+    {
+        if ((middle.load(std::memory_order_relaxed) & freshBit) == 0)
+            return false;
+
+        auto previous = middle.exchange(readIndex, std::memory_order_acq_rel);
+        readIndex = previous & indexMask;
+        return true;
+    }
+
+    const T& getReadBuffer() const { return buffers[readIndex]; }
+
+    // The reader owns this one until its next pull, it may swap the contents out
+    T& getReadBuffer() { return buffers[readIndex]; }
+
+private:
+    static constexpr int indexMask = 3;
+    static constexpr int freshBit = 4;
+
+    std::array<T, 3> buffers;
+    int writeIndex = 0, readIndex = 1;
+    std::atomic<int> middle{ 2 };
+};
+
+
+
+// BPR -> lock-free single producer / single consumer ring of samples. The audio thread copies
+// each block in with at most two memcpys, the reader looks at any recent window in place.
+// Positions are absolute sample counts, so the reader keeps its own cursor and never moves
+// anything the writer can see.
+
+struct SampleRing
 {
-    void prepare(int numChannels, int numSamples)
+    // A window as it lies in the ring: first, then the wrapped remainder (often empty)
+    struct Window
+    {
+        const float* first = nullptr;
+        int firstSize = 0;
+        const float* second = nullptr;
+        int secondSize = 0;
+    };
+
+    // Rounds up to a power of two. Allocated once, so a reader never sees the storage move.
+    explicit SampleRing(int minimumCapacity)
+        : samples((size_t)juce::nextPowerOfTwo(minimumCapacity), 0.f),
+          mask((juce::int64)samples.size() - 1)
     {
-        
-        for (auto& buffer : buffers)
-        {
-            buffer.setSize(numChannels, numSamples, false, true, true);
-            buffer.clear();
-        }
     }
 
-    void prepare(size_t numElements)
+    // Writer side, while the audio thread is stopped: fills the whole ring with silence the way
+    // push() writes, so the positions keep counting up and a reader's copy is still checked
+    void clear()
     {
-        
-        for (auto& buffer : buffers)
-        {
-            buffer.clear();
-            buffer.resize(numElements, 0);
-        }
+        const auto position = written.load(std::memory_order_relaxed) + getCapacity();
+
+        writeStart.store(position, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        std::fill(samples.begin(), samples.end(), 0.f);
+
+        written.store(position, std::memory_order_release);
     }
 
-    bool push(const T& t)
+    int getCapacity() const { return (int)samples.size(); }
+
+    // Audio thread
+    template<typename SampleType>
+    void push(const SampleType* data, int numSamples)
     {
-        auto write = fifo.write(1);
-        if (write.blockSize1 > 0)
-        {
-            buffers[write.startIndex1] = t;
-            return true;
-        }
-        return false;
+        // A block bigger than the whole ring goes in as several pushes
+        for (; numSamples > getCapacity(); data += getCapacity(), numSamples -= getCapacity())
+            push(data, getCapacity());
+
+        const auto position = written.load(std::memory_order_relaxed);
+        const auto start = (int)(position & mask);
+        const auto firstSize = juce::jmin(numSamples, getCapacity() - start);
+
+        // Announce the region first, so a reader overlapping it knows to throw its copy away
+        writeStart.store(position + numSamples, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        copy(data, samples.data() + start, firstSize);
+        copy(data + firstSize, samples.data(), numSamples - firstSize);
+
+        written.store(position + numSamples, std::memory_order_release);
     }
 
-    bool pull(T& t)
+    // Reader: total samples pushed so far, everything before this is readable
+    juce::int64 getNumWritten() const { return written.load(std::memory_order_acquire); }
+
+    // Reader: the numSamples ending at the absolute position end. Samples from before the first
+    // push read as zeros. Whatever is read out of the window is only good if isIntact() still
+    // holds afterwards.
+    Window getWindow(juce::int64 end, int numSamples) const
     {
-        auto read = fifo.read(1);
-        if (read.blockSize1 > 0)
-        {
-            t = buffers[read.startIndex1];
-            return true;
-        }
-
-        return false;
+        jassert(numSamples <= getCapacity());
+
+        const auto start = (int)((end - numSamples) & mask);
+        const auto firstSize = juce::jmin(numSamples, getCapacity() - start);
+
+        return { samples.data() + start, firstSize, samples.data(), numSamples - firstSize };
     }
 
-    int getNumAvailableForReading() const
+    // Reader: nothing from the absolute position start onwards has been overwritten, including
+    // by a push still in progress
+    bool isIntact(juce::int64 start) const
     {
-        return fifo.getNumReady();
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return writeStart.load(std::memory_order_relaxed) - getCapacity() <= start;
     }
+
 private:
-    static constexpr int Capacity = 30;
-    std::array<T, Capacity> buffers;
-    juce::AbstractFifo fifo{ Capacity };
-};
+    static void copy(const float* source, float* destination, int numSamples)
+    {
+        if (numSamples > 0)
+            std::memcpy(destination, source, sizeof(float) * (size_t)numSamples);
+    }
 
+    // Double precision hosts, converted on the way in
+    static void copy(const double* source, float* destination, int numSamples)
+    {
+        for (int i = 0; i < numSamples; ++i)
+            destination[i] = (float)source[i];
+    }
 
+    std::vector<float> samples;
+    const juce::int64 mask;
+    std::atomic<juce::int64> writeStart{ 0 }, written{ 0 };
+};
+
+// BPR -> one output channel captured for the analyzer
 
-template<typename BlockType>
 struct SingleChannelSampleFifo
 {
+    // Longest window the analyzer may ask for. The ring holds two of them plus blocks of up
+    // to two more, longer blocks only make the analyzer drop the odd frame.
+    static constexpr int maxWindowSize = 1 << 14;
+    static constexpr int ringCapacity = maxWindowSize * 4;
+
     SingleChannelSampleFifo(Channel ch) : channelToUse(ch)
     {
         prepared.set(false);
     }
-    void update(const BlockType& buffer)
+    // Either sample type, the analyzer only ever sees floats
+    template<typename SampleType>
+    void update(const juce::AudioBuffer<SampleType>& buffer)
     {
-        
-        auto* channelPtr = buffer.getReadPointer(channelToUse);
+        // A mono bus has no second channel, both analyzers show channel 0 then
+        auto* channelPtr = buffer.getReadPointer(juce::jmin((int)channelToUse, buffer.getNumChannels() - 1));
 
-        for (int i = 0; i < buffer.getNumSamples(); ++i)
-        {
-            pushNextSampleIntoFifo(channelPtr[i]);
-        }
+        ring.push(channelPtr, buffer.getNumSamples());
     }
+    // The analyzer thread may be reading meanwhile, so the ring is only cleared, never reallocated
     void prepare(int bufferSize)
     {
         prepared.set(false);
         size.set(bufferSize);
 
-        bufferToFill.setSize(1, bufferSize, false, true, true);
-        audioBufferFifo.prepare(1, bufferSize);
-        fifoIndex = 0;
+        ring.clear();
         prepared.set(true);
     }
 
-
-    int getNumCompleteBuffersAvailable() const { return audioBufferFifo.getNumAvailableForReading(); }
     bool isPrepared() const { return prepared.get(); }
     int getSize() const { return size.get(); }
 
-    bool getAudioBuffer(BlockType& buf) { return audioBufferFifo.pull(buf); }
+    const SampleRing& getRing() const { return ring; }
 
 private:
 
     Channel channelToUse;
-    int fifoIndex = 0;
-    Fifo<BlockType> audioBufferFifo;
-    BlockType bufferToFill;
+    SampleRing ring { ringCapacity };
     juce::Atomic<bool> prepared = false;
     juce::Atomic<int> size = 0;
-
-    void pushNextSampleIntoFifo(float sample)
-    {
-        if (fifoIndex == bufferToFill.getNumSamples())
-        {
-            auto ok = audioBufferFifo.push(bufferToFill);
-
-            juce::ignoreUnused(ok);
-
-            fifoIndex = 0;
-        }
-
-        bufferToFill.setSample(0, fifoIndex, sample);
-        ++fifoIndex;
-    }
 };
 
 // BPR -> enum for the slope
@@ -147,6 +231,43 @@ enum Slope
     Slope_48
 };
 
+// BPR -> the parametric bands, one second order section each on top of the MonoChain bands
+
+enum BandType
+{
+    Band_Off,
+    Band_Peak,
+    Band_LowShelf,
+    Band_HighShelf,
+    Band_Notch,
+    Band_LowCut,
+    Band_HighCut
+};
+
+struct BandSettings
+{
+    BandType type { BandType::Band_Off };
+    float freq { 1000.f }, gainInDecibels { 0.f }, quality { 1.f };
+
+    bool operator==(const BandSettings& other) const
+    {
+        return type == other.type && freq == other.freq
+            && gainInDecibels == other.gainInDecibels && quality == other.quality;
+    }
+
+    bool operator!=(const BandSettings& other) const { return ! (*this == other); }
+};
+
+using ParametricBandSettings = std::array<BandSettings, BiquadCascade::maxParametricBands>;
+
+
+// BPR -> a cut parked at the end of its frequency range is switched off, so the default
+// settings leave the signal untouched and the chain can drop out entirely
+
+constexpr float minCutFreq = 20.f, maxCutFreq = 20000.f;
+
+inline bool isLowCutParked(double frequency) { return frequency <= minCutFreq; }
+inline bool isHighCutParked(double frequency) { return frequency >= maxCutFreq; }
 
 // BPR -> Chain setting saver
 
@@ -156,16 +277,149 @@ struct ChainSettings
     float lowCutFreq { 0 }, highCutFreq { 0 };
     Slope lowCutSlope { Slope::Slope_12 }, highCutSlope {Slope::Slope_12 };
     float masterVolume{ 100 };
+    ParametricBandSettings bands;
+
+    // BPR -> per band comparisons, so only the sections whose inputs moved get redesigned
+
+    bool hasSameLowCut(const ChainSettings& other) const
+    {
+        return lowCutFreq == other.lowCutFreq && lowCutSlope == other.lowCutSlope;
+    }
+
+    bool hasSamePeak(const ChainSettings& other) const
+    {
+        return peakFreq == other.peakFreq
+            && peakGainInDecibels == other.peakGainInDecibels
+            && peakQuality == other.peakQuality;
+    }
+
+    bool hasSameHighCut(const ChainSettings& other) const
+    {
+        return highCutFreq == other.highCutFreq && highCutSlope == other.highCutSlope;
+    }
+
+    bool hasSameBands(const ChainSettings& other) const
+    {
+        return bands == other.bands;
+    }
+
+    bool operator==(const ChainSettings& other) const
+    {
+        return hasSameLowCut(other) && hasSamePeak(other) && hasSameHighCut(other)
+            && hasSameBands(other) && masterVolume == other.masterVolume;
+    }
+
+    bool operator!=(const ChainSettings& other) const { return ! (*this == other); }
 };
 
-using Filter = juce::dsp::IIR::Filter<float>;
+// BPR -> the chain types for either sample type, Filter / CutFilter / MonoChain are the float ones
+
+template<typename SampleType>
+using BasicFilter = juce::dsp::IIR::Filter<SampleType>;
+
+template<typename SampleType>
+using BasicCutFilter = juce::dsp::ProcessorChain<BasicFilter<SampleType>, BasicFilter<SampleType>,
+                                                 BasicFilter<SampleType>, BasicFilter<SampleType>>;
+
+template<typename SampleType>
+using BasicMonoChain = juce::dsp::ProcessorChain<BasicCutFilter<SampleType>, BasicFilter<SampleType>, BasicCutFilter<SampleType>>;
+
+using Filter = BasicFilter<float>;
 
-using CutFilter = juce::dsp::ProcessorChain<Filter, Filter, Filter, Filter>;
+using CutFilter = BasicCutFilter<float>;
 
-using MonoChain = juce::dsp::ProcessorChain<CutFilter, Filter, CutFilter>;
+using MonoChain = BasicMonoChain<float>;
 
 ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts);
 
+// BPR -> the raw parameter values behind ChainSettings, looked up once so the audio thread
+// can read them every block without going through the parameter IDs. The prefix selects
+// another set of band parameters (e.g. "Side "), Master Volume is shared by all of them.
+
+struct ChainSettingsParameters
+{
+    explicit ChainSettingsParameters(juce::AudioProcessorValueTreeState& apvts, const juce::String& prefix = {});
+
+    ChainSettings load() const;
+
+private:
+    std::atomic<float>* lowCutFreq, * highCutFreq, * peakFreq, * peakGain, * peakQuality;
+    std::atomic<float>* lowCutSlope, * highCutSlope, * masterVolume;
+
+    // Only the unprefixed set has parametric bands, they run on every lane
+    struct BandParameters
+    {
+        std::atomic<float>* type = nullptr, * freq = nullptr, * gain = nullptr, * quality = nullptr;
+    };
+
+    std::array<BandParameters, BiquadCascade::maxParametricBands> bands;
+};
+
+// BPR -> audio thread smoothing of the continuous ChainSettings values. The filters follow
+// the ramps once per smoothing block, so smoothness and redesign cost don't depend on the
+// host buffer size.
+
+struct SmoothedChainSettings
+{
+    static constexpr int smoothingBlockSize = 32;
+
+    void reset(double sampleRate, const ChainSettings& chainSettings);
+    void setTargets(const ChainSettings& chainSettings);
+
+    // Advances every ramp by numSamples and returns the values reached
+    ChainSettings advance(int numSamples);
+
+    // Where the ramps are right now, without advancing them
+    ChainSettings getCurrent() const;
+
+    const ChainSettings& getTargets() const { return targets; }
+
+    // Single sample steps of one band's ramps, for retuning the SVF engine every sample
+    // without copying the whole ChainSettings
+    float getNextLowCutFreq() { return lowCutFreq.getNextValue(); }
+    float getNextHighCutFreq() { return highCutFreq.getNextValue(); }
+    float getNextPeakFreq() { return peakFreq.getNextValue(); }
+    float getNextPeakQuality() { return peakQuality.getNextValue(); }
+    float getNextPeakGainInDecibels() { return peakGainInDecibels.getNextValue(); }
+
+    bool isLowCutSmoothing() const { return lowCutFreq.isSmoothing(); }
+    bool isPeakSmoothing() const { return peakFreq.isSmoothing() || peakGainInDecibels.isSmoothing() || peakQuality.isSmoothing(); }
+    bool isHighCutSmoothing() const { return highCutFreq.isSmoothing(); }
+    bool isMonoChainSmoothing() const { return isLowCutSmoothing() || isPeakSmoothing() || isHighCutSmoothing(); }
+
+    // Parametric bands ramp frequency, gain and Q like the peak. A new band type, or a band
+    // switched on or off, can't ramp and jumps straight to its target.
+    bool isBandSmoothing(int index) const { return bands[(size_t)index].isSmoothing(); }
+    bool isBandsSmoothing() const;
+
+    bool isSmoothing() const { return isMonoChainSmoothing() || isBandsSmoothing(); }
+
+    // Advances only the band ramps, for the SVF engine which steps the others itself
+    ParametricBandSettings advanceBands(int numSamples);
+
+    // Cut frequencies jump straight to their target, used while the cuts run in parallel form
+    void skipCutSmoothing();
+
+    // Every value jumps straight to its target
+    void skipSmoothing();
+
+private:
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative> peakFreq, peakQuality, lowCutFreq, highCutFreq;
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear> peakGainInDecibels;
+
+    struct SmoothedBand
+    {
+        juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative> freq, quality;
+        juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear> gainInDecibels;
+
+        bool isSmoothing() const { return freq.isSmoothing() || gainInDecibels.isSmoothing() || quality.isSmoothing(); }
+        void setCurrentAndTargetValues(const BandSettings& band);
+    };
+
+    std::array<SmoothedBand, BiquadCascade::maxParametricBands> bands;
+    ChainSettings targets;
+};
+
 enum ChainPositions
 {
     LowCut,
@@ -173,11 +427,96 @@ enum ChainPositions
     HighCut
 };
 
-using Coefficients = Filter::CoefficientsPtr;
+template<typename SampleType>
+using BasicCoefficients = typename BasicFilter<SampleType>::CoefficientsPtr;
+
+using Coefficients = BasicCoefficients<float>;
+
+// BPR -> where every MonoChain stage lives inside the BiquadCascade
+
+enum CascadeSections
+{
+    LowCutSections = 0,
+    PeakSection = 4,
+    HighCutSections = 5,
+    ParametricBandSections = 9
+};
+
+// BPR -> one immutable, fully designed set of coefficients for a MonoChain.
+// Every band carries its own version, bumped whenever that band was redesigned,
+// indexed by ChainPositions.
+
+struct ChainCoefficients
+{
+    BiquadCoefficients peak;
+    std::array<BiquadCoefficients, 4> lowCut, highCut;
+    ParallelSections lowCutParallel, highCutParallel;
+    Slope lowCutSlope { Slope::Slope_12 }, highCutSlope { Slope::Slope_12 };
+    std::array<juce::uint32, 3> versions {};
+
+    // Parametric bands, a band that is off has no section in the cascade
+    std::array<BiquadCoefficients, BiquadCascade::maxParametricBands> bands;
+    std::array<bool, BiquadCascade::maxParametricBands> bandsActive {};
+    juce::uint32 bandsVersion = 0;
+};
+
+template<typename SampleType>
+BiquadCoefficients makeBiquadCoefficients(const juce::dsp::IIR::Coefficients<SampleType>& coefficients)
+{
+    // The raw array of a second order section is b0, b1, b2, a1, a2, already divided by a0
+    jassert(coefficients.getFilterOrder() == 2);
+
+    auto* raw = coefficients.getRawCoefficients();
+
+    return { (double)raw[0], (double)raw[1], (double)raw[2], (double)raw[3], (double)raw[4] };
+}
+
+void designLowCutSections(const ChainSettings& chainSettings, double sampleRate, std::array<BiquadCoefficients, 4>& sections);
+void designHighCutSections(const ChainSettings& chainSettings, double sampleRate, std::array<BiquadCoefficients, 4>& sections);
+BiquadCoefficients designPeakSection(const ChainSettings& chainSettings, double sampleRate);
+BiquadCoefficients designBandSection(const BandSettings& bandSettings, double sampleRate);
+
+// BPR -> the cut designs go through the shared cache when one is given
+void designLowCutCoefficients(const ChainSettings& chainSettings, double sampleRate, ChainCoefficients& chainCoefficients, CutFilterCache* cache = nullptr);
+void designPeakCoefficients(const ChainSettings& chainSettings, double sampleRate, ChainCoefficients& chainCoefficients);
+void designHighCutCoefficients(const ChainSettings& chainSettings, double sampleRate, ChainCoefficients& chainCoefficients, CutFilterCache* cache = nullptr);
+void designParametricBandCoefficients(const ChainSettings& chainSettings, double sampleRate, ChainCoefficients& chainCoefficients);
+
+ChainCoefficients makeChainCoefficients(const ChainSettings& chainSettings, double sampleRate);
 
-void updateCoefficients(Coefficients& old, const Coefficients& replacements);
+// BPR -> product of the magnitudes of every active section, evenly spaced from 0 Hz up to
+// sampleRate / 2 over magnitudes.size() bins, the target response of the linear phase FIR
+void getChainMagnitudes(const ChainCoefficients& chainCoefficients, std::vector<double>& magnitudes);
 
-Coefficients makePeakFilter(const ChainSettings& chainSettings, double sampleRate);
+// BPR -> samples until the impulse response of the active sections, run one after the other,
+// has decayed by decayFactor. Transparent sections don't ring and are left out.
+double getChainTailLength(const ChainCoefficients& chainCoefficients, double decayFactor, double maxLength);
+
+template<typename SampleType>
+void updateCoefficients(juce::ReferenceCountedObjectPtr<juce::dsp::IIR::Coefficients<SampleType>>& old,
+                        const juce::ReferenceCountedObjectPtr<juce::dsp::IIR::Coefficients<SampleType>>& replacements)
+{
+    *old = *replacements;
+}
+
+template<typename SampleType>
+void updateCutSections(BasicBiquadCascade<SampleType>& cascade,
+    int firstSection,
+    const std::array<BiquadCoefficients, 4>& coefficients,
+    const Slope& slope,
+    int lane = BiquadCascade::allLanes);
+
+template<typename SampleType>
+void bypassCutSections(BasicBiquadCascade<SampleType>& cascade, int firstSection);
+
+template<typename SampleType = float>
+BasicCoefficients<SampleType> makePeakFilter(const ChainSettings& chainSettings, double sampleRate)
+{
+    return juce::dsp::IIR::Coefficients<SampleType>::makePeakFilter(sampleRate,
+        (SampleType)chainSettings.peakFreq,
+        (SampleType)chainSettings.peakQuality,
+        (SampleType)juce::Decibels::decibelsToGain(chainSettings.peakGainInDecibels));
+}
 
 template<int Index, typename ChainType, typename CoefficientType>
 void update(ChainType& chain, const CoefficientType& coefficients)
@@ -187,16 +526,22 @@ void update(ChainType& chain, const CoefficientType& coefficients)
 }
 
 
+template<typename ChainType>
+void bypassCutFilter(ChainType& chain)
+{
+    chain.template setBypassed<0>(true);
+    chain.template setBypassed<1>(true);
+    chain.template setBypassed<2>(true);
+    chain.template setBypassed<3>(true);
+}
+
 template<typename ChainType, typename CoefficientType>
 void updateCutFilter(
     ChainType& chain,
     const CoefficientType& coefficients,
     const Slope& slope)
 {
-    chain.template setBypassed<0>(true);
-    chain.template setBypassed<1>(true);
-    chain.template setBypassed<2>(true);
-    chain.template setBypassed<3>(true);
+    bypassCutFilter(chain);
 
     switch (slope)
     {
@@ -222,17 +567,19 @@ void updateCutFilter(
     }
 }
 
-inline auto makeLowCutFilter(const ChainSettings& chainSettings, double sampleRate)
+template<typename SampleType = float>
+auto makeLowCutFilter(const ChainSettings& chainSettings, double sampleRate)
 {
-    return juce::dsp::FilterDesign<float>::designIIRHighpassHighOrderButterworthMethod(
+    return juce::dsp::FilterDesign<SampleType>::designIIRHighpassHighOrderButterworthMethod(
         chainSettings.lowCutFreq,
         sampleRate,
         (chainSettings.lowCutSlope + 1) * 2);
 }
 
-inline auto makeHighCutFilter(const ChainSettings& chainSettings, double sampleRate)
+template<typename SampleType = float>
+auto makeHighCutFilter(const ChainSettings& chainSettings, double sampleRate)
 {
-    return juce::dsp::FilterDesign<float>::designIIRLowpassHighOrderButterworthMethod(
+    return juce::dsp::FilterDesign<SampleType>::designIIRLowpassHighOrderButterworthMethod(
         chainSettings.highCutFreq,
         sampleRate,
         (chainSettings.highCutSlope + 1) * 2);
@@ -241,7 +588,10 @@ inline auto makeHighCutFilter(const ChainSettings& chainSettings, double sampleR
 //==============================================================================
 /**
 */
-class SimpleEQAudioProcessor  : public juce::AudioProcessor
+class SimpleEQAudioProcessor  : public juce::AudioProcessor,
+                                private juce::AudioProcessorValueTreeState::Listener,
+                                private juce::TimeSliceClient,
+                                private juce::AsyncUpdater
                             #if JucePlugin_Enable_ARA
                              , public juce::AudioProcessorARAExtension
                             #endif
@@ -260,6 +610,10 @@ public:
    #endif
 
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+
+    // BPR - Both sample types run natively, a 64 bit host mix needs no conversions
+    bool supportsDoublePrecisionProcessing() const override { return true; }
 
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -290,27 +644,264 @@ public:
 
     juce::AudioProcessorValueTreeState apvts{ *this,nullptr, "Parameters", createParameterLayout()};
 
-    using BlockType = juce::AudioBuffer<float>;
+    // BPR -> Analyzer display settings. Saved with the session as properties of the state tree
+    // rather than as parameters, a host has no business automating them and changing one must
+    // not make the filters redesign. Set from the message thread, the analyzer thread reads them.
+
+    static juce::StringArray getAnalyzerOverlapChoices() { return { "None", "50%", "75%", "87.5%" }; }
 
-    SingleChannelSampleFifo<BlockType> leftChannelFifo{ Channel::Left };
-    SingleChannelSampleFifo<BlockType> rightChannelFifo{ Channel::Right };
+    int getAnalyzerOverlap() const { return analyzerOverlap.load(std::memory_order_relaxed); }
+    void setAnalyzerOverlap(int overlapIndex);
+
+    // FFT size: finer low end for more CPU
+    static juce::StringArray getAnalyzerResolutionChoices() { return { "2048", "4096", "8192", "16384" }; }
+
+    int getAnalyzerResolution() const { return analyzerResolution.load(std::memory_order_relaxed); }
+    void setAnalyzerResolution(int resolutionIndex);
+
+
+    SingleChannelSampleFifo leftChannelFifo{ Channel::Left };
+    SingleChannelSampleFifo rightChannelFifo{ Channel::Right };
 
 private:
 
-    // BPR - DSP implementation
-    MonoChain leftChain, rightChain;
+    // BPR - DSP implementation, one set of engines per sample type. The host picks the precision
+    // before prepareToPlay, only that set is prepared and fed coefficients from then on.
 
-    juce::AudioParameterFloat* masterVolumeParam;
+    template<typename SampleType>
+    struct Engines
+    {
+        // Every channel of the bus runs the MonoChain layout in one SIMD cascade
+        BasicBiquadCascade<SampleType> filterChain;
 
-   
+        // Optional parallel form of the cut filters, these replace the cut sections of filterChain
+        BasicParallelCutFilter<SampleType> lowCutParallel, highCutParallel;
+
+        BasicSvfChain<SampleType> svfChain;
+
+        // What the outgoing side of a linear phase handover works on, one block of every channel
+        juce::AudioBuffer<SampleType> handoverBuffer;
+
+        // The other engine's signal while the SVF engine takes over from filterChain or back
+        juce::AudioBuffer<SampleType> svfHandoverBuffer;
+    };
+
+    std::tuple<Engines<float>, Engines<double>> engines;
+
+    template<typename SampleType>
+    Engines<SampleType>& getEngines() { return std::get<Engines<SampleType>>(engines); }
+
+    template<typename SampleType>
+    const Engines<SampleType>& getEngines() const { return std::get<Engines<SampleType>>(engines); }
+
+    template<typename SampleType>
+    void prepareEngines(const juce::dsp::ProcessSpec& spec, BiquadProcessingMode processingMode);
+
+    template<typename SampleType>
+    void process(juce::AudioBuffer<SampleType>& buffer);
+
+    std::atomic<float>* cutFilterFormParam = nullptr;
+    bool parallelCutsApplied = false;
+
+    // BPR - Both processing modes run on the same section state, a change applies from the next block
+    std::atomic<float>* processingModeParam = nullptr;
+    BiquadProcessingMode getProcessingMode() const;
+
+    // BPR - One set of band settings on its way from the parameters into filterChain. The main
+    // path drives every lane, or only the mid lane in mid/side mode, the side path the side lane.
+
+    struct FilterPath
+    {
+        FilterPath(juce::AudioProcessorValueTreeState& apvts, const juce::String& prefix)
+            : parameters(apvts, prefix) {}
+
+        ChainSettingsParameters parameters;
+
+        // Parameter smoothing, the ramping bands are redesigned on the audio thread
+        SmoothedChainSettings smoothed;
+
+        TripleBuffer<ChainCoefficients> published;
+
+        // Guarded by designLock: what was last designed and published
+        ChainSettings designedSettings;
+        ChainCoefficients designedCoefficients;
+
+        // Audio thread only: band versions currently written into filterChain
+        std::array<juce::uint32, 3> appliedVersions {};
+        juce::uint32 appliedBandsVersion = 0;
+    };
+
+    FilterPath mainPath{ apvts, {} }, sidePath{ apvts, "Side " };
+
+    // BPR - Mid/side: lane 0 of filterChain carries the mid, lane 1 the side
+    static constexpr int midLane = 0, sideLane = 1;
+
+    std::atomic<float>* stereoModeParam = nullptr;
+    bool midSideApplied = false;
+
+    int getMainLane() const { return midSideApplied ? midLane : BiquadCascade::allLanes; }
+
+    // Mid/side needs a stereo bus, and runs the cuts as cascades: the parallel form has no
+    // per lane coefficients
+    bool wantsMidSide() const;
+    bool wantsParallelCuts() const;
+    bool isSmoothing() const;
+
+    // BPR - Every section transparent and done fading out: the biquad engine stops and the
+    // input passes straight through. The engines crossfade their own way into that state.
+    template<typename SampleType> bool isTransparent() const;
+
+    template<typename SampleType> void updateSmoothedFilters(int numSamples);
+    template<typename SampleType> void updateSmoothedFilters(FilterPath& path, int lane, int numSamples);
+    template<typename SampleType> void processChain(const juce::dsp::AudioBlock<SampleType>& block,
+                                                    const juce::dsp::AudioBlock<SampleType>& outgoingInput);
+
+    // BPR - SVF engine, retuned every sample while a parameter ramps instead of every smoothing
+    // block. It takes over the cuts and the peak, the parametric bands keep running in
+    // filterChain after it. Mid/side and the parallel cut form only exist in the biquad engine,
+    // which stays in charge while either is selected.
+    std::atomic<float>* filterEngineParam = nullptr;
+    bool svfEngineApplied = false;
+    ChainSettings svfSettings;
+
+    // Switching engines crossfades filterChain from the sections it ran to the ones it runs
+    // now. Set while that lasts, the outgoing sections get the signal the old engine saw.
+    bool svfHandover = false;
+
+    // Cut stages currently switched on in svfChain, -1 until the first update after a reset
+    int svfLowCutStages = -1, svfHighCutStages = -1;
+
+    bool shouldUseSvfEngine() const;
+
+    template<typename SampleType> void updateSvfFilters(const ChainSettings& chainSettings, bool lowCut, bool peak, bool highCut);
+    template<typename SampleType> void updateSvfLowCut(float frequency, Slope slope);
+    template<typename SampleType> void updateSvfHighCut(float frequency, Slope slope);
+    template<typename SampleType> void updateSvfPeak(float frequency, float quality, float gainInDecibels);
+    template<typename SampleType> void processSvf(const juce::dsp::AudioBlock<SampleType>& block);
+    template<typename SampleType> void processSvfStages(const juce::dsp::AudioBlock<SampleType>& block);
+    template<typename SampleType> juce::dsp::AudioBlock<SampleType> getSvfHandoverBlock(const juce::dsp::AudioBlock<SampleType>& block);
+
+    // BPR - Master Volume, 0 to 100 % of the signal. The biquad engine applies the ramp on its
+    // way out of the cascade, the other engines and an empty chain get a gain ramp pass.
+
+    static constexpr double masterGainRampSeconds = 0.05;
+
+    juce::AudioParameterFloat* masterVolumeParam = nullptr;
+    juce::SmoothedValue<float> masterGain;
+
+    float getMasterGainTarget() const { return masterVolumeParam->get() / 100.f; }
+    template<typename SampleType> void applyMasterGain(juce::AudioBuffer<SampleType>& buffer);
+
+    // BPR - Linear phase mode: the main path's response as one FIR, designed on the design
+    // thread and run by the convolver instead of any of the engines above. In mid/side the mid
+    // runs that FIR and the side gets its own, from the side settings and the shared bands.
+    // A setup (on or off, with its convolvers) is built in prepareToPlay, or on the message thread when one of its
+    // parameters changes, which also reports the new latency to the host. The audio thread
+    // swaps a new setup in and crossfades to it from whatever ran before: the outgoing side
+    // keeps running until the incoming convolver has filled its latency, then they crossfade
+    // over linearPhaseFadeSeconds.
+
+    struct LinearPhaseSetup
+    {
+        bool enabled = false, midSide = false;
+        int latency = 0;
+
+        // Every channel, or only the mid when midSide is set
+        PartitionedConvolver convolver, sideConvolver;
+    };
+
+    // Published together, so the mid and the side crossfade to new kernels in the same block.
+    // side is only designed in mid/side.
+    struct LinearPhaseKernels
+    {
+        LinearPhaseKernel main, side;
+    };
+
+    static constexpr double linearPhaseFadeSeconds = 0.02;
+
+    // Only keeps prepareToPlay and the message thread from configuring at the same time
+    juce::CriticalSection linearPhaseLock;
+
+    TripleBuffer<LinearPhaseSetup> linearPhaseSetups;
+    TripleBuffer<LinearPhaseKernels> linearPhaseKernels;
+
+    // Audio thread only: the setup running, the one being faded out, and where the handover is
+    LinearPhaseSetup linearPhaseCurrent, linearPhaseOutgoing;
+    int handoverRemaining = 0, handoverFadeLength = 0;
+
+    // Guarded by designLock, and only changed by configureLinearPhase
+    LinearPhaseDesigner linearPhaseDesigner;
+    bool linearPhaseDesignEnabled = false, linearPhaseMidSide = false;
+    int linearPhaseChannels = 0;
+
+    void configureLinearPhase(double sampleRate, int samplesPerBlock, int numChannels, bool forceSetup = false);
+    void designLinearPhaseKernel();
+    void handleAsyncUpdate() override;
+
+    static bool isLinearPhaseParameter(const juce::String& parameterID);
+
+    template<typename SampleType> void pullLinearPhaseUpdates();
+    template<typename SampleType> void processLinearPhase(const juce::dsp::AudioBlock<SampleType>& block, LinearPhaseSetup& setup);
+    template<typename SampleType> void processEngines(juce::AudioBuffer<SampleType>& buffer, LinearPhaseSetup& setup);
+    template<typename SampleType> void processHandover(juce::AudioBuffer<SampleType>& buffer);
+
+    // BPR - Sleep: once every input channel has been silent for longer than the filters ring,
+    // no engine runs and the output is cleared. The tail is worked out from the designed poles
+    // and is what getTailLengthSeconds reports.
+
+    static constexpr float silenceThreshold = 1.0e-6f;   // -120 dB, also what the tail decays to
+    static constexpr double maxTailSeconds = 10.0;
+
+    std::atomic<int> tailSamples{ 0 };
+
+    // Audio thread only: samples since each input channel last went above silenceThreshold
+    std::vector<juce::int64> silentSamples;
+    bool sleeping = false;
+
+    template<typename SampleType> bool isSilentAndDecayed(const juce::AudioBuffer<SampleType>& buffer);
+    template<typename SampleType> void resetEngines();
+    void updateTailLength(double sampleRate);
+
+    // BPR - Coefficient pipeline: designed on a shared background thread, picked up by processBlock
+
+    struct CoefficientDesignThread : juce::TimeSliceThread
+    {
+        CoefficientDesignThread() : juce::TimeSliceThread("EQQ Coefficient Designer") { startThread(); }
+        ~CoefficientDesignThread() override { stopThread(1000); }
+    };
+
+    juce::SharedResourcePointer<CoefficientDesignThread> designThread;
+    juce::SharedResourcePointer<CutFilterCache> cutFilterCache;
+
+    juce::CriticalSection designLock;
+    std::atomic<juce::uint32> settingsEpoch{ 0 }, designedEpoch{ 0 };
+    std::atomic<double> designSampleRate{ 0.0 };
+
+    std::atomic<int> analyzerOverlap{ 1 }, analyzerResolution{ 0 };
+
+    void readAnalyzerSettings();
+
+    // Guarded by designLock
+    double designedSampleRate = 0.0;
+
+    void parameterChanged(const juce::String& parameterID, float newValue) override;
+    int useTimeSlice() override;
+
+    void designCoefficients(bool forceRedesign);
+    bool designCoefficients(FilterPath& path, double sampleRate, bool forceRedesign);
 
-    void updatePeakFilter(const ChainSettings& chainSettings);
+    template<typename SampleType> void updatePeakFilter(const ChainCoefficients& chainCoefficients, int lane);
 
 
-    void updateLowCutFilters(const ChainSettings& chainSettings);
-    void updateHighCutFilters(const ChainSettings& chainSettings);
+    template<typename SampleType> void updateLowCutFilters(const ChainCoefficients& chainCoefficients, int lane);
+    template<typename SampleType> void updateHighCutFilters(const ChainCoefficients& chainCoefficients, int lane);
+    template<typename SampleType> void updateParametricBands();
+    template<typename SampleType> void updateSmoothedBands(int numSamples);
+    template<typename SampleType> void updateSmoothedBands(const std::array<bool, BiquadCascade::maxParametricBands>& wereSmoothing,
+                                                           const ParametricBandSettings& bands);
 
-    void updateFilters();
+    template<typename SampleType> void updateFilters(bool reapplyAll = false);
+    template<typename SampleType> void updateFilters(FilterPath& path, int lane, bool formChanged);
    
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SimpleEQAudioProcessor)
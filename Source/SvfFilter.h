@@ -0,0 +1,265 @@
+/*
+  ==============================================================================
+
+    Topology preserving (TPT) state variable filter engine, an alternative to
+    the biquad cascade that can be retuned every sample.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "BiquadDesign.h"
+
+#include <array>
+#include <cmath>
+#include <vector>
+
+// BPR -> Trapezoidal integrated state variable filter (Simper / Zavalishin). Moving the
+// cutoff is one tan() per band plus a few multiplies, and because the state lives in the
+// integrators instead of past outputs, the filter stays well behaved when the coefficients
+// change from one sample to the next.
+//
+// With g = tan(pi f / fs) every stage computes
+//   v3 = v0 - ic2, v1 = a1 ic1 + a2 v3, v2 = ic2 + a2 ic1 + a3 v3
+//   out = m0 v0 + m1 v1 + m2 v2
+// and the responses are the same bilinear transforms as the RBJ / Butterworth biquads:
+//   high pass: k = 1 / Q, m = (1, -k, -1)
+//   low pass: k = 1 / Q, m = (0, 0, 1)
+//   bell: k = 1 / (Q A), m = (1, k (A^2 - 1), 0), A = sqrt(gain factor)
+//
+// Like BiquadCascade the channels are the lanes of a SIMDRegister, in lane groups of
+// Register::size() channels, and the stages use the same MonoChain layout: four low cut
+// stages, the peak, four high cut stages. SvfChain is the float engine, BasicSvfChain<double>
+// the double precision one.
+//
+// A stage switched on or off while the chain runs (a cut parked at its end of the range, or
+// a slope change) fades its output against its input over crossfadeSeconds instead of
+// stepping. A stage fading out keeps its state and coefficients until it reaches its input,
+// a stage fading in starts from silence.
+
+template<typename SampleType>
+struct BasicSvfChain
+{
+    using Register = juce::dsp::SIMDRegister<SampleType>;
+
+    static constexpr int maxStages = 9;
+    static constexpr int numLanes = (int)Register::size();
+    static constexpr int maxCutStages = 4;
+    static constexpr double crossfadeSeconds = 0.005;
+
+    void prepare(const juce::dsp::ProcessSpec& spec)
+    {
+        sampleRate = spec.sampleRate;
+        fadeStep = (SampleType)1 / (SampleType)juce::jmax(1, juce::roundToInt(spec.sampleRate * crossfadeSeconds));
+        groups.resize((size_t)juce::jmax(1, ((int)spec.numChannels + numLanes - 1) / numLanes));
+        channels.resize(groups.size() * (size_t)numLanes);
+        reset();
+    }
+
+    // Back to silence, stages switched on or off before the next block don't fade
+    void reset()
+    {
+        for (auto& group : groups)
+            for (auto& state : group)
+                state = {};
+
+        for (auto& stage : stages)
+            stage.wet = stage.active ? (SampleType)1 : (SampleType)0;
+
+        running = false;
+    }
+
+    // numStages Butterworth stages (order numStages * 2) starting at firstStage,
+    // the remaining cut stages of that band are switched off (all of them for numStages == 0)
+    void setCutStages(int firstStage, int numStages, bool isHighPass)
+    {
+        jassert(numStages >= 0 && numStages <= maxCutStages);
+
+        const auto order = numStages * 2;
+
+        for (int i = 0; i < maxCutStages; ++i)
+        {
+            auto& stage = stages[(size_t)(firstStage + i)];
+            const auto shouldBeActive = i < numStages;
+
+            if (shouldBeActive && ! stage.active && stage.wet == (SampleType)0)
+                for (auto& group : groups)
+                    group[(size_t)(firstStage + i)] = {};
+
+            setActive(stage, shouldBeActive);
+
+            if (! shouldBeActive)
+                continue;
+
+            stage.k = (SampleType)BiquadDesign::getButterworthDamping(order, i);
+
+            if (isHighPass)
+                setMix(stage, 1, -stage.k, -1);
+            else
+                setMix(stage, 0, 0, 1);
+        }
+    }
+
+    // One tan() for the whole band, every active stage shares the cutoff
+    void setCutFrequency(int firstStage, float frequency)
+    {
+        const auto g = getG(frequency);
+
+        for (int i = 0; i < maxCutStages; ++i)
+        {
+            auto& stage = stages[(size_t)(firstStage + i)];
+
+            if (stage.active)
+                setIntegrators(stage, g, stage.k);
+        }
+    }
+
+    void setPeak(int index, float frequency, float quality, float gainFactor)
+    {
+        auto& stage = stages[(size_t)index];
+
+        const auto A = std::sqrt(juce::jmax((SampleType)0, (SampleType)gainFactor));
+        const auto k = (SampleType)1 / ((SampleType)quality * A);
+
+        setActive(stage, true);
+        stage.k = k;
+        setIntegrators(stage, getG(frequency), k);
+        setMix(stage, 1, k * (A * A - 1), 0);
+    }
+
+    // Channel c runs in lane c % numLanes of group c / numLanes, unused lanes run on silence
+    void process(const juce::dsp::AudioBlock<SampleType>& block)
+    {
+        process(block, [] {});
+    }
+
+    // Same, with retune() called before every sample so it can move the coefficients (and
+    // switch stages) in place while the block runs
+    template<typename RetuneFunction>
+    void process(const juce::dsp::AudioBlock<SampleType>& block, RetuneFunction&& retune)
+    {
+        running = true;
+
+        const auto numChannels = juce::jmin((int)block.getNumChannels(), (int)groups.size() * numLanes);
+        const auto numSamples = block.getNumSamples();
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            channels[(size_t)ch] = block.getChannelPointer((size_t)ch);
+
+        for (size_t i = 0; i < numSamples; ++i)
+        {
+            retune();
+
+            for (auto& stage : stages)
+                stage.advanceFade(fadeStep);
+
+            for (int group = 0; group * numLanes < numChannels; ++group)
+            {
+                const auto first = (size_t)(group * numLanes);
+                const auto numInGroup = (size_t)juce::jmin(numLanes, numChannels - group * numLanes);
+                auto& states = groups[(size_t)group];
+
+                auto v0 = Register::expand(0);
+
+                for (size_t lane = 0; lane < numInGroup; ++lane)
+                    v0.set(lane, channels[first + lane][i]);
+
+                for (size_t s = 0; s < (size_t)maxStages; ++s)
+                {
+                    const auto& stage = stages[s];
+
+                    if (stage.wet == (SampleType)1)
+                        v0 = processStage(stage, states[s], v0);
+                    else if (stage.wet > (SampleType)0)
+                        v0 = v0 + ((processStage(stage, states[s], v0) - v0) * stage.wet);
+                }
+
+                for (size_t lane = 0; lane < numInGroup; ++lane)
+                    channels[first + lane][i] = v0.get(lane);
+            }
+        }
+    }
+
+private:
+    struct Stage
+    {
+        Register a1, a2, a3, m0, m1, m2;
+        SampleType k = 1;
+        bool active = false;
+
+        // Share of the stage's output in what it passes on, moves by one fadeStep per sample
+        // towards active. A stage only runs while this is above zero.
+        SampleType wet = 0;
+
+        void advanceFade(SampleType step) noexcept
+        {
+            if (active && wet < (SampleType)1)
+                wet = juce::jmin((SampleType)1, wet + step);
+            else if (! active && wet > (SampleType)0)
+                wet = juce::jmax((SampleType)0, wet - step);
+        }
+    };
+
+    struct State
+    {
+        Register ic1 = Register::expand(0), ic2 = Register::expand(0);
+    };
+
+    std::array<Stage, maxStages> stages;
+    std::vector<std::array<State, maxStages>> groups { 1 };
+    std::vector<SampleType*> channels = std::vector<SampleType*>((size_t)numLanes, nullptr);
+    double sampleRate = 44100.0;
+    SampleType fadeStep = 1;
+
+    // Set by process(), switching a stage before the first block after a reset needs no fade
+    bool running = false;
+
+    void setActive(Stage& stage, bool shouldBeActive) const
+    {
+        stage.active = shouldBeActive;
+
+        if (! running)
+            stage.wet = shouldBeActive ? (SampleType)1 : (SampleType)0;
+    }
+
+    SampleType getG(float frequency) const
+    {
+        // Kept below Nyquist, tan() blows up at fs / 2
+        const auto limited = juce::jlimit(1.0, sampleRate * 0.49, (double)frequency);
+        return (SampleType)std::tan(juce::MathConstants<double>::pi * limited / sampleRate);
+    }
+
+    static void setIntegrators(Stage& stage, SampleType g, SampleType k)
+    {
+        const auto a1 = (SampleType)1 / ((SampleType)1 + g * (g + k));
+        const auto a2 = g * a1;
+
+        stage.a1 = Register::expand(a1);
+        stage.a2 = Register::expand(a2);
+        stage.a3 = Register::expand(g * a2);
+    }
+
+    static void setMix(Stage& stage, SampleType m0, SampleType m1, SampleType m2)
+    {
+        stage.m0 = Register::expand(m0);
+        stage.m1 = Register::expand(m1);
+        stage.m2 = Register::expand(m2);
+    }
+
+    static forcedinline Register processStage(const Stage& stage, State& state, Register v0) noexcept
+    {
+        const auto v3 = v0 - state.ic2;
+        const auto v1 = (stage.a1 * state.ic1) + (stage.a2 * v3);
+        const auto v2 = state.ic2 + (stage.a2 * state.ic1) + (stage.a3 * v3);
+
+        state.ic1 = (v1 + v1) - state.ic1;
+        state.ic2 = (v2 + v2) - state.ic2;
+
+        return (stage.m0 * v0) + (stage.m1 * v1) + (stage.m2 * v2);
+    }
+};
+
+using SvfChain = BasicSvfChain<float>;
@@ -0,0 +1,386 @@
+/*
+  ==============================================================================
+
+    BiquadCascade against juce::dsp::IIR, the filters it replaced, its two
+    processing modes against each other, the crossfade when a section is
+    bypassed, and handing a section over to the SVF engine and back.
+
+  ==============================================================================
+*/
+
+#include "TestSignals.h"
+
+#include "../../Source/BiquadDesign.h"
+#include "../../Source/SvfFilter.h"
+
+// BPR - The sections the plugin would run for a 120 Hz / 36 dB/oct low cut, a 1 kHz peak and a
+// 9 kHz / 48 dB/oct high cut, at their cascade positions
+
+static std::vector<std::pair<int, BiquadCoefficients>> makeTestChain(double sampleRate)
+{
+    std::vector<std::pair<int, BiquadCoefficients>> chain;
+    std::array<BiquadCoefficients, 4> sections;
+
+    BiquadDesign::makeButterworthHighPass(sampleRate, 120.0, 6, sections);
+
+    for (int i = 0; i < 3; ++i)
+        chain.push_back({ i, sections[(size_t)i] });
+
+    chain.push_back({ 4, BiquadDesign::makePeak(sampleRate, 1000.0, 0.7, juce::Decibels::decibelsToGain(6.0)) });
+
+    BiquadDesign::makeButterworthLowPass(sampleRate, 9000.0, 8, sections);
+
+    for (int i = 0; i < 4; ++i)
+        chain.push_back({ 5 + i, sections[(size_t)i] });
+
+    return chain;
+}
+
+// BPR - Rounded the way the float engine loads them, so both sides run the same numbers
+static BiquadCoefficients roundedToFloat(const BiquadCoefficients& c)
+{
+    return { (double)(float)c.b0, (double)(float)c.b1, (double)(float)c.b2, (double)(float)c.a1, (double)(float)c.a2 };
+}
+
+struct BiquadCascadeTests : juce::UnitTest
+{
+    BiquadCascadeTests() : juce::UnitTest("BiquadCascade", "EQQ") {}
+
+    static constexpr double sampleRate = 48000.0;
+    static constexpr int numSamples = 8192;
+
+    void runTest() override
+    {
+        auto random = getRandom();
+
+        beginTest("Float cascade is bit exact with juce::dsp::IIR");
+        {
+            // Six channels, so the second lane group is only half full
+            TestSignal<float> signal(random, 6, numSamples);
+            auto reference = signal;
+
+            BiquadCascade cascade;
+            cascade.prepare({ sampleRate, 512, 6 });
+
+            std::vector<juce::dsp::IIR::Filter<float>> filters;
+
+            for (const auto& [index, coefficients] : makeTestChain(sampleRate))
+            {
+                const auto c = roundedToFloat(coefficients);
+
+                cascade.setCoefficients(index, c);
+                cascade.setBypassed(index, false);
+
+                filters.emplace_back(new juce::dsp::IIR::Coefficients<float>((float)c.b0, (float)c.b1, (float)c.b2,
+                                                                             1.f, (float)c.a1, (float)c.a2));
+            }
+
+            processInChunks(signal.getBlock(), [&](const juce::dsp::AudioBlock<float>& block) { cascade.process(block); });
+
+            // processSample() rather than process(), the block version snaps the state to zero
+            for (auto& channel : reference.channels)
+            {
+                for (auto& filter : filters)
+                {
+                    filter.reset();
+
+                    for (auto& sample : channel)
+                        sample = filter.processSample(sample);
+                }
+            }
+
+            expectEquals(getMaxDifference(signal, reference), 0.0);
+        }
+
+        beginTest("State space matches per sample (float)");
+        expectWithinAbsoluteError(compareProcessingModes<float>(random), 0.0, 1.0e-3);
+
+        beginTest("State space matches per sample (double)");
+        expectWithinAbsoluteError(compareProcessingModes<double>(random), 0.0, 1.0e-9);
+
+        beginTest("Bypassing a running section crossfades");
+        {
+            // DC through a 20 Hz high pass: the output settles at zero while the section holds
+            // the whole input in its state. Bypassing it has to ramp back up to the input.
+            BasicBiquadCascade<double> cascade;
+            cascade.prepare({ sampleRate, 512, 1 });
+
+            std::array<BiquadCoefficients, 4> sections;
+            BiquadDesign::makeButterworthHighPass(sampleRate, 20.0, 2, sections);
+            cascade.setCoefficients(0, sections[0]);
+            cascade.setBypassed(0, false);
+
+            std::vector<double> samples((size_t)sampleRate, 0.5);
+            double* channel = samples.data();
+            juce::dsp::AudioBlock<double> block(&channel, 1, samples.size());
+
+            const auto half = samples.size() / 2;
+            cascade.process(block.getSubBlock(0, half));
+            expectWithinAbsoluteError(samples[half - 1], 0.0, 1.0e-3);
+
+            cascade.setBypassed(0, true);
+            processInChunks(block.getSubBlock(half), [&](const juce::dsp::AudioBlock<double>& b) { cascade.process(b); });
+
+            auto maxStep = 0.0;
+
+            for (auto i = half; i < samples.size(); ++i)
+                maxStep = juce::jmax(maxStep, std::abs(samples[i] - samples[i - 1]));
+
+            const auto fadeLength = sampleRate * BasicBiquadCascade<double>::crossfadeSeconds;
+
+            expectLessOrEqual(maxStep, 0.5 / fadeLength * 1.5);
+            expectEquals(samples.back(), 0.5);
+            expect(cascade.isTransparent());
+        }
+
+        beginTest("Handing a section to the SVF engine and back keeps the level");
+        expectWithinAbsoluteError(getWorstLevelThroughHandovers(), 0.0, 0.02);
+    }
+
+    // BPR -> a 1 kHz sine through a 1 kHz high pass, the way the processor switches engines: the
+    // SVF chain in front of the cascade takes the cut over, then hands it back. One cut leaves
+    // the sine 3 dB down, the cut applied twice 6 dB, so any share of the output that went
+    // through both engines shows up as a dip.
+    static double getWorstLevelThroughHandovers()
+    {
+        constexpr double cutoff = 1000.0;
+
+        BasicSvfChain<double> svfChain;
+        svfChain.prepare({ sampleRate, 512, 1 });
+        svfChain.setCutStages(0, 1, true);
+        svfChain.setCutFrequency(0, (float)cutoff);
+
+        BasicBiquadCascade<double> cascade;
+        cascade.prepare({ sampleRate, 512, 1 });
+
+        std::array<BiquadCoefficients, 4> sections;
+        BiquadDesign::makeButterworthHighPass(sampleRate, cutoff, 2, sections);
+        cascade.setCoefficients(0, sections[0]);
+        cascade.setBypassed(0, false);
+
+        const auto period = (size_t)juce::roundToInt(sampleRate / cutoff);
+        const auto stageLength = period * 50;
+
+        std::vector<double> samples(stageLength * 3), input(samples.size());
+
+        for (size_t i = 0; i < samples.size(); ++i)
+            samples[i] = std::sin(juce::MathConstants<double>::twoPi * cutoff * (double)i / sampleRate);
+
+        double* channels[] = { samples.data(), input.data() };
+        juce::dsp::AudioBlock<double> block(channels, 1, samples.size());
+        juce::dsp::AudioBlock<double> inputBlock(channels + 1, 1, samples.size());
+
+        const auto processStage = [&](size_t start, bool svfRuns, bool svfOutgoing)
+        {
+            processInChunks(block.getSubBlock(start, stageLength), [&](const juce::dsp::AudioBlock<double>& b)
+            {
+                auto copy = inputBlock.getSubBlock((size_t)(b.getChannelPointer(0) - samples.data()), b.getNumSamples());
+                copy.copyFrom(b);
+
+                if (svfOutgoing)
+                    svfChain.process(copy);
+                else if (svfRuns)
+                    svfChain.process(b);
+
+                cascade.process(b, copy);
+            });
+        };
+
+        // On the cascade, then over to the SVF chain with the cascade's sections fading out on
+        // the input, then back with them fading in while the bands fade out on the SVF output
+        processStage(0, false, false);
+
+        cascade.beginCrossfade();
+        cascade.setBypassed(0, true);
+        processStage(stageLength, true, false);
+
+        cascade.beginCrossfade();
+        cascade.setBypassed(0, false);
+        processStage(stageLength * 2, false, true);
+
+        // Past the first few periods, where the cascade is still settling
+        auto worst = 0.0;
+
+        for (auto start = period * 10; start + period <= samples.size(); start += period)
+        {
+            auto peak = 0.0;
+
+            for (auto i = start; i < start + period; ++i)
+                peak = juce::jmax(peak, std::abs(samples[i]));
+
+            worst = juce::jmax(worst, std::abs(peak - std::sqrt(0.5)));
+        }
+
+        return worst;
+    }
+
+    template<typename SampleType>
+    double compareProcessingModes(juce::Random& random)
+    {
+        TestSignal<SampleType> perSample(random, 3, numSamples);
+        auto stateSpace = perSample;
+
+        BasicBiquadCascade<SampleType> cascades[2];
+
+        cascades[0].prepare({ sampleRate, 512, 3 }, BiquadProcessingMode::perSample);
+        cascades[1].prepare({ sampleRate, 512, 3 }, BiquadProcessingMode::blockStateSpace);
+
+        for (auto& cascade : cascades)
+        {
+            for (const auto& [index, coefficients] : makeTestChain(sampleRate))
+            {
+                cascade.setCoefficients(index, coefficients);
+                cascade.setBypassed(index, false);
+            }
+        }
+
+        processInChunks(perSample.getBlock(), [&](const juce::dsp::AudioBlock<SampleType>& block) { cascades[0].process(block); });
+        processInChunks(stateSpace.getBlock(), [&](const juce::dsp::AudioBlock<SampleType>& block) { cascades[1].process(block); });
+
+        return getMaxDifference(perSample, stateSpace);
+    }
+};
+
+static BiquadCascadeTests biquadCascadeTests;
+
+// BPR -> the stereo chain the way the plugin ran it before the cascade, one chain of
+// juce::dsp::IIR::Filter per channel, every filter over the whole block, against the cascade
+// running both channels in one pass
+
+struct BiquadCascadeBenchmarks : juce::UnitTest
+{
+    BiquadCascadeBenchmarks() : juce::UnitTest("BiquadCascade", "EQQ Benchmarks") {}
+
+    static constexpr double sampleRate = 48000.0;
+    static constexpr int blockSize = 512;
+    static constexpr int numBlocks = 938;   // 10 s at 48 kHz
+    static constexpr int numRuns = 5;
+
+    void runTest() override
+    {
+        juce::ScopedNoDenormals noDenormals;
+        auto random = getRandom();
+
+        beginTest("Stereo cascade against two juce::dsp::IIR chains");
+
+        // Every block starts from the same noise, so neither side ends up on denormals
+        TestSignal<float> input(random, 2, blockSize);
+        auto output = input;
+        auto block = output.getBlock();
+
+        BiquadCascade cascade;
+        cascade.prepare({ sampleRate, (juce::uint32)blockSize, 2 });
+
+        std::vector<std::vector<juce::dsp::IIR::Filter<float>>> chains(2);
+
+        for (const auto& [index, coefficients] : makeTestChain(sampleRate))
+        {
+            const auto c = roundedToFloat(coefficients);
+
+            cascade.setCoefficients(index, c);
+            cascade.setBypassed(index, false);
+
+            for (auto& chain : chains)
+                chain.emplace_back(new juce::dsp::IIR::Coefficients<float>((float)c.b0, (float)c.b1, (float)c.b2,
+                                                                           1.f, (float)c.a1, (float)c.a2));
+        }
+
+        const auto cascadeTime = getMillisecondsPerRun(numRuns, [&]
+        {
+            for (int i = 0; i < numBlocks; ++i)
+            {
+                block.copyFrom(input.getBlock());
+                cascade.process(block);
+            }
+        });
+
+        const auto referenceTime = getMillisecondsPerRun(numRuns, [&]
+        {
+            for (int i = 0; i < numBlocks; ++i)
+            {
+                block.copyFrom(input.getBlock());
+
+                for (size_t ch = 0; ch < chains.size(); ++ch)
+                {
+                    auto channelBlock = block.getSingleChannelBlock(ch);
+                    juce::dsp::ProcessContextReplacing<float> context(channelBlock);
+
+                    for (auto& filter : chains[ch])
+                        filter.process(context);
+                }
+            }
+        });
+
+        logMessage("10 s of stereo through 9 sections: cascade " + juce::String(cascadeTime, 2)
+                   + " ms, juce::dsp::IIR " + juce::String(referenceTime, 2)
+                   + " ms, speedup " + juce::String(referenceTime / cascadeTime, 2) + "x");
+    }
+};
+
+static BiquadCascadeBenchmarks biquadCascadeBenchmarks;
+
+// BPR -> one channel, where the per sample recursion has no second lane to hide behind, through
+// the same sections in both processing modes
+
+struct BiquadStateSpaceBenchmarks : juce::UnitTest
+{
+    BiquadStateSpaceBenchmarks() : juce::UnitTest("BiquadCascade state space", "EQQ Benchmarks") {}
+
+    static constexpr double sampleRate = 48000.0;
+    static constexpr int blockSize = 4096;
+    static constexpr int numBlocks = 118;   // 10 s at 48 kHz
+    static constexpr int numRuns = 5;
+
+    void runTest() override
+    {
+        juce::ScopedNoDenormals noDenormals;
+        auto random = getRandom();
+
+        benchmark<float>(random);
+        benchmark<double>(random);
+    }
+
+    template<typename SampleType>
+    void benchmark(juce::Random& random)
+    {
+        beginTest(juce::String("Mono state space against per sample (") + (std::is_same_v<SampleType, float> ? "float)" : "double)"));
+
+        TestSignal<SampleType> input(random, 1, blockSize);
+        auto output = input;
+        auto block = output.getBlock();
+
+        BasicBiquadCascade<SampleType> cascades[2];
+
+        cascades[0].prepare({ sampleRate, (juce::uint32)blockSize, 1 }, BiquadProcessingMode::perSample);
+        cascades[1].prepare({ sampleRate, (juce::uint32)blockSize, 1 }, BiquadProcessingMode::blockStateSpace);
+
+        for (auto& cascade : cascades)
+        {
+            for (const auto& [index, coefficients] : makeTestChain(sampleRate))
+            {
+                cascade.setCoefficients(index, coefficients);
+                cascade.setBypassed(index, false);
+            }
+        }
+
+        double times[2];
+
+        for (int mode = 0; mode < 2; ++mode)
+        {
+            times[mode] = getMillisecondsPerRun(numRuns, [&]
+            {
+                for (int i = 0; i < numBlocks; ++i)
+                {
+                    block.copyFrom(input.getBlock());
+                    cascades[mode].process(block);
+                }
+            });
+        }
+
+        logMessage("10 s of mono through 9 sections in " + juce::String(blockSize) + " sample blocks: per sample "
+                   + juce::String(times[0], 2) + " ms, state space " + juce::String(times[1], 2)
+                   + " ms, speedup " + juce::String(times[0] / times[1], 2) + "x");
+    }
+};
+
+static BiquadStateSpaceBenchmarks biquadStateSpaceBenchmarks;
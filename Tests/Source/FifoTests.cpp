@@ -0,0 +1,204 @@
+/*
+  ==============================================================================
+
+    Fifo hands elements over by swapping them with its slots, and counts the
+    pushes and pulls it had to refuse.
+
+  ==============================================================================
+*/
+
+#include "TestSignals.h"
+
+#include "../../Source/Fifo.h"
+
+#include <set>
+
+struct FifoTests : juce::UnitTest
+{
+    FifoTests() : juce::UnitTest("Fifo", "EQQ") {}
+
+    static constexpr int capacity = 4;
+    static constexpr size_t blockSize = 16;
+
+    void runTest() override
+    {
+        beginTest("Push hands back the slot's previous element");
+        {
+            Fifo<std::vector<float>, capacity> fifo;
+            fifo.prepare(blockSize);
+
+            std::vector<float> block(blockSize, 1.f);
+            const auto* pushedData = block.data();
+
+            expect(fifo.push(block));
+
+            // What comes back is one of the prepared slots, not the block that went in
+            expect(block.data() != pushedData);
+            expectEquals((int)block.size(), (int)blockSize);
+            expectEquals(block.front(), 0.f);
+
+            // The consumer gets the very same storage, nothing was copied on the way
+            std::vector<float> received;
+            expect(fifo.pull(received));
+            expect(received.data() == pushedData);
+            expectEquals(received.front(), 1.f);
+        }
+
+        beginTest("Elements keep circulating without allocating");
+        {
+            Fifo<std::vector<float>, capacity> fifo;
+            fifo.prepare(blockSize);
+
+            std::vector<float> producer(blockSize), consumer(blockSize);
+            std::set<const float*> storage { producer.data(), consumer.data() };
+
+            // The slots plus the two ends, every one of them has to be seen
+            for (int i = 0; i < (capacity + 1) * 4; ++i)
+            {
+                expect(fifo.push(producer));
+                storage.insert(producer.data());
+
+                expect(fifo.pull(consumer));
+                storage.insert(consumer.data());
+            }
+
+            expectEquals((int)storage.size(), capacity + 1 + 2);
+        }
+
+        beginTest("Overflows and underflows are counted");
+        {
+            Fifo<std::vector<float>, capacity> fifo;
+            fifo.prepare(blockSize);
+
+            std::vector<float> block(blockSize);
+
+            expect(! fifo.pull(block));
+            expectEquals(fifo.getNumUnderflows(), 1);
+
+            for (int i = 0; i < capacity; ++i)
+                expect(fifo.push(block));
+
+            expectEquals(fifo.getNumAvailableForReading(), capacity);
+            expectEquals(fifo.getNumOverflows(), 0);
+
+            // A refused push leaves the element with the caller
+            block.assign(blockSize, 2.f);
+            const auto* refusedData = block.data();
+
+            expect(! fifo.push(block));
+            expectEquals(fifo.getNumOverflows(), 1);
+            expect(block.data() == refusedData);
+
+            for (int i = 0; i < capacity; ++i)
+                expect(fifo.pull(block));
+
+            expect(! fifo.pull(block));
+            expectEquals(fifo.getNumUnderflows(), 2);
+            expectEquals(fifo.getNumOverflows(), 1);
+        }
+    }
+};
+
+static FifoTests fifoTests;
+
+// BPR -> the Fifo as it was before the slots were swapped: push and pull copy assign the
+// element, which for the FFT data is the whole block, twice
+
+template<typename T, int Capacity = 30>
+struct CopyingFifo
+{
+    void prepare(size_t numElements)
+    {
+        for (auto& buffer : buffers)
+        {
+            buffer.clear();
+            buffer.resize(numElements, 0);
+        }
+    }
+
+    bool push(const T& t)
+    {
+        auto write = fifo.write(1);
+        if (write.blockSize1 > 0)
+        {
+            buffers[write.startIndex1] = t;
+            return true;
+        }
+        return false;
+    }
+
+    bool pull(T& t)
+    {
+        auto read = fifo.read(1);
+        if (read.blockSize1 > 0)
+        {
+            t = buffers[read.startIndex1];
+            return true;
+        }
+
+        return false;
+    }
+
+private:
+    std::array<T, Capacity> buffers;
+    juce::AbstractFifo fifo{ Capacity };
+};
+
+// BPR -> FFT data blocks of the smallest and the largest analyzer order, pushed in bursts the way
+// the path producer drains them
+
+struct FifoBenchmarks : juce::UnitTest
+{
+    FifoBenchmarks() : juce::UnitTest("Fifo", "EQQ Benchmarks") {}
+
+    static constexpr int numBursts = 2000;
+    static constexpr int burstLength = 8;
+    static constexpr int numRuns = 5;
+
+    void runTest() override
+    {
+        for (const auto fftSize : { 2048, 16384 })
+        {
+            beginTest("Swapping against copying, " + juce::String(fftSize) + " point FFT data");
+
+            const auto blockSize = (size_t)fftSize * 2;
+
+            Fifo<std::vector<float>> swapping;
+            CopyingFifo<std::vector<float>> copying;
+            swapping.prepare(blockSize);
+            copying.prepare(blockSize);
+
+            std::vector<float> producer(blockSize, 1.f), consumer(blockSize);
+
+            const auto swappingTime = getMillisecondsPerRun(numRuns, [&]
+            {
+                for (int i = 0; i < numBursts; ++i)
+                {
+                    for (int j = 0; j < burstLength; ++j)
+                        swapping.push(producer);
+
+                    for (int j = 0; j < burstLength; ++j)
+                        swapping.pull(consumer);
+                }
+            });
+
+            const auto copyingTime = getMillisecondsPerRun(numRuns, [&]
+            {
+                for (int i = 0; i < numBursts; ++i)
+                {
+                    for (int j = 0; j < burstLength; ++j)
+                        copying.push(producer);
+
+                    for (int j = 0; j < burstLength; ++j)
+                        copying.pull(consumer);
+                }
+            });
+
+            logMessage(juce::String(numBursts * burstLength) + " blocks: swapping " + juce::String(swappingTime, 2)
+                       + " ms, copying " + juce::String(copyingTime, 2) + " ms, speedup "
+                       + juce::String(copyingTime / swappingTime, 2) + "x");
+        }
+    }
+};
+
+static FifoBenchmarks fifoBenchmarks;
@@ -0,0 +1,146 @@
+/*
+  ==============================================================================
+
+    Latency of the linear phase path: what the plugin reports has to be where
+    the signal actually comes out, and kernels only ever moving forward.
+
+  ==============================================================================
+*/
+
+#include "TestSignals.h"
+
+#include "../../Source/LinearPhaseConvolver.h"
+
+struct LinearPhaseConvolverTests : juce::UnitTest
+{
+    LinearPhaseConvolverTests() : juce::UnitTest("LinearPhaseConvolver", "EQQ") {}
+
+    static constexpr double sampleRate = 48000.0;
+
+    void runTest() override
+    {
+        auto random = getRandom();
+
+        // Uniform, then non uniform with the tail in 4 and 16 times larger partitions
+        for (const auto& [partitionSize, tailPartitionSize] : { std::make_pair(256, 0),
+                                                                std::make_pair(128, 512),
+                                                                std::make_pair(64, 1024) })
+        {
+            beginTest("Flat kernel is a pure delay of the reported latency, partitions "
+                      + juce::String(partitionSize) + " / " + juce::String(tailPartitionSize));
+
+            const auto firLength = LinearPhaseDesigner::getFirLength(sampleRate);
+
+            // Flat magnitudes, which design() leaves in place after prepare()
+            LinearPhaseDesigner designer;
+            designer.prepare(firLength, partitionSize, tailPartitionSize);
+
+            LinearPhaseKernel kernel;
+            designer.design(kernel);
+
+            PartitionedConvolver convolver;
+            convolver.prepare(2, LinearPhaseDesigner::makeLayout(firLength, partitionSize, tailPartitionSize));
+            convolver.setKernel(kernel);
+
+            // The same sum PluginProcessor reports through setLatencySamples()
+            const auto latency = convolver.getLatencyInSamples() + firLength / 2;
+
+            const auto numSamples = latency + 8192;
+            TestSignal<float> input(random, 2, numSamples);
+            auto output = input;
+
+            processInChunks(output.getBlock(), [&](const juce::dsp::AudioBlock<float>& block) { convolver.process(block); });
+
+            auto maxDifference = 0.0;
+
+            for (size_t ch = 0; ch < input.channels.size(); ++ch)
+                for (int i = latency; i < numSamples; ++i)
+                    maxDifference = juce::jmax(maxDifference, std::abs((double)output.channels[ch][(size_t)i]
+                                                                     - (double)input.channels[ch][(size_t)(i - latency)]));
+
+            expectWithinAbsoluteError(maxDifference, 0.0, 1.0e-4);
+        }
+
+        beginTest("Kernels older than the running one are ignored");
+        {
+            const auto firLength = LinearPhaseDesigner::getFirLength(sampleRate);
+
+            LinearPhaseDesigner designer;
+            designer.prepare(firLength, 256);
+
+            LinearPhaseKernel older, newer;
+            designer.design(older);
+            designer.design(newer);
+
+            PartitionedConvolver convolver;
+            convolver.prepare(1, LinearPhaseDesigner::makeLayout(firLength, 256, 0));
+
+            convolver.setKernel(newer);
+            expect(convolver.canAcceptKernel());
+
+            // A stale kernel arriving after the newer one must not start a crossfade back to it
+            convolver.setKernel(older);
+            expect(convolver.canAcceptKernel());
+        }
+    }
+};
+
+static LinearPhaseConvolverTests linearPhaseConvolverTests;
+
+// BPR -> the same 64 sample latency, once with every partition 64 samples and once with the
+// tail in 1024 sample partitions, over 64 sample callbacks
+
+struct LinearPhaseConvolverBenchmarks : juce::UnitTest
+{
+    LinearPhaseConvolverBenchmarks() : juce::UnitTest("LinearPhaseConvolver", "EQQ Benchmarks") {}
+
+    static constexpr double sampleRate = 48000.0;
+    static constexpr int blockSize = 64;
+    static constexpr int numBlocks = 7500;   // 10 s at 48 kHz
+    static constexpr int numRuns = 3;
+
+    void runTest() override
+    {
+        juce::ScopedNoDenormals noDenormals;
+        auto random = getRandom();
+
+        beginTest("Non uniform against uniform partitions at the same latency");
+
+        const auto firLength = LinearPhaseDesigner::getFirLength(sampleRate);
+
+        TestSignal<float> input(random, 2, blockSize);
+        auto output = input;
+        auto block = output.getBlock();
+
+        double times[2];
+        int tailPartitionSizes[] = { 0, 1024 };
+
+        for (int i = 0; i < 2; ++i)
+        {
+            LinearPhaseDesigner designer;
+            designer.prepare(firLength, blockSize, tailPartitionSizes[i]);
+
+            LinearPhaseKernel kernel;
+            designer.design(kernel);
+
+            PartitionedConvolver convolver;
+            convolver.prepare(2, LinearPhaseDesigner::makeLayout(firLength, blockSize, tailPartitionSizes[i]));
+            convolver.setKernel(kernel);
+
+            times[i] = getMillisecondsPerRun(numRuns, [&]
+            {
+                for (int b = 0; b < numBlocks; ++b)
+                {
+                    block.copyFrom(input.getBlock());
+                    convolver.process(block);
+                }
+            });
+        }
+
+        logMessage("10 s of stereo through a " + juce::String(firLength) + " tap FIR in " + juce::String(blockSize)
+                   + " sample blocks: uniform " + juce::String(times[0], 2) + " ms, non uniform "
+                   + juce::String(times[1], 2) + " ms, speedup " + juce::String(times[0] / times[1], 2) + "x");
+    }
+};
+
+static LinearPhaseConvolverBenchmarks linearPhaseConvolverBenchmarks;
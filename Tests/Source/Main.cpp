@@ -0,0 +1,36 @@
+/*
+  ==============================================================================
+
+    Console runner for the engine unit tests. Returns 1 when any test failed,
+    so it can gate a build. With --benchmark it also times the engines against
+    what they replaced and logs the results.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+
+// The runner only keeps the results of the last run
+static bool runCategory(juce::UnitTestRunner& runner, const juce::String& category)
+{
+    runner.runTestsInCategory(category);
+
+    for (int i = 0; i < runner.getNumResults(); ++i)
+        if (runner.getResult(i)->failures > 0)
+            return false;
+
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    juce::UnitTestRunner runner;
+    runner.setAssertOnFailure(false);
+
+    auto passed = runCategory(runner, "EQQ");
+
+    if (argc > 1 && juce::String(argv[1]) == "--benchmark")
+        passed = runCategory(runner, "EQQ Benchmarks") && passed;
+
+    return passed ? 0 : 1;
+}
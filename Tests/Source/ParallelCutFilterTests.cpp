@@ -0,0 +1,207 @@
+/*
+  ==============================================================================
+
+    Parallel form cut filters against the cascade they are expanded from, at
+    every sample rate the plugin is expected to run at.
+
+  ==============================================================================
+*/
+
+#include "TestSignals.h"
+
+#include "../../Source/BiquadDesign.h"
+#include "../../Source/ParallelCutFilter.h"
+
+static constexpr double testSampleRates[] = { 44100.0, 48000.0, 88200.0, 96000.0, 176400.0, 192000.0 };
+
+// BPR - The Butterworth cut the plugin designs for frequency / order, as the cascade
+static std::array<BiquadCoefficients, 4> makeCutCascade(double sampleRate, double frequency, int order, bool isHighPass)
+{
+    std::array<BiquadCoefficients, 4> cascade;
+
+    if (isHighPass)
+        BiquadDesign::makeButterworthHighPass(sampleRate, frequency, order, cascade);
+    else
+        BiquadDesign::makeButterworthLowPass(sampleRate, frequency, order, cascade);
+
+    return cascade;
+}
+
+struct ParallelCutFilterTests : juce::UnitTest
+{
+    ParallelCutFilterTests() : juce::UnitTest("ParallelCutFilter", "EQQ") {}
+
+    void runTest() override
+    {
+        auto random = getRandom();
+
+        for (const auto sampleRate : testSampleRates)
+        {
+            beginTest("Accuracy at " + juce::String(sampleRate / 1000.0, 1) + " kHz");
+
+            int numDesigns = 0, numExpanded = 0;
+            auto worstResponse = 0.0, worstDouble = 0.0, worstFloat = 0.0;
+
+            for (const auto isHighPass : { true, false })
+            {
+                for (const auto frequency : { 20.0, 50.0, 100.0, 200.0, 500.0, 1000.0, 2000.0, 5000.0, 10000.0, 15000.0 })
+                {
+                    for (int order = 2; order <= 8; order += 2)
+                    {
+                        const auto cascade = makeCutCascade(sampleRate, frequency, order, isHighPass);
+                        const auto numSections = order / 2;
+                        const auto sections = makeParallelSections(cascade, numSections, sampleRate);
+
+                        ++numDesigns;
+
+                        // Designs that don't expand stay on the cascade, nothing to check
+                        if (! sections.isValid)
+                            continue;
+
+                        ++numExpanded;
+
+                        worstResponse = juce::jmax(worstResponse, getResponseErrorInDecibels(cascade, numSections, sections, sampleRate));
+                        worstDouble = juce::jmax(worstDouble, compareWithCascade<double>(random, cascade, numSections, sections, sampleRate));
+                        worstFloat = juce::jmax(worstFloat, compareWithCascade<float>(random, cascade, numSections, sections, sampleRate));
+                    }
+                }
+            }
+
+            logMessage(juce::String(numExpanded) + " of " + juce::String(numDesigns) + " cut filters expand, worst response error "
+                       + juce::String(worstResponse, 4) + " dB, worst output error " + juce::String(worstDouble) + " (double) / "
+                       + juce::String(worstFloat) + " (float)");
+
+            expect(numExpanded > 0);
+            expectLessOrEqual(worstResponse, 0.1);
+            expectLessOrEqual(worstDouble, 1.0e-9);
+            // A 20 Hz cut at 96 kHz and up has its poles within 1e-3 of the unit circle, float
+            // rounding alone puts either form about 1e-3 off there
+            expectLessOrEqual(worstFloat, 2.0e-3);
+        }
+    }
+
+    // Magnitude response of the float rounded parallel form against the cascade, where it is audible
+    static double getResponseErrorInDecibels(const std::array<BiquadCoefficients, 4>& cascade, int numSections,
+                                             const ParallelSections& sections, double sampleRate)
+    {
+        const auto rounded = sections.roundedToFloat();
+        auto maxErrorInDecibels = 0.0;
+
+        for (double freq = 20.0; freq <= 20000.0 && freq < sampleRate * 0.5; freq *= 1.1)
+        {
+            const auto w = std::polar(1.0, -juce::MathConstants<double>::twoPi * freq / sampleRate);
+            const auto reference = std::abs(ParallelForm::getResponse(cascade, numSections, w));
+            const auto parallel = std::abs(ParallelForm::getResponse(rounded, numSections, w));
+
+            if (reference > 1.0e-3)
+                maxErrorInDecibels = juce::jmax(maxErrorInDecibels,
+                                                std::abs(juce::Decibels::gainToDecibels(parallel) - juce::Decibels::gainToDecibels(reference)));
+        }
+
+        return maxErrorInDecibels;
+    }
+
+    // The engine itself against the same sections run as a cascade
+    template<typename SampleType>
+    double compareWithCascade(juce::Random& random, const std::array<BiquadCoefficients, 4>& cascade,
+                              int numSections, const ParallelSections& sections, double sampleRate)
+    {
+        TestSignal<SampleType> parallelOutput(random, 2, 8192);
+        auto cascadeOutput = parallelOutput;
+
+        BasicParallelCutFilter<SampleType> parallelFilter;
+        parallelFilter.prepare(2, sampleRate);
+        parallelFilter.setSections(sections);
+        parallelFilter.setActive(true);
+
+        BasicBiquadCascade<SampleType> cascadeFilter;
+        cascadeFilter.prepare({ sampleRate, 512, 2 });
+
+        for (int i = 0; i < numSections; ++i)
+        {
+            cascadeFilter.setCoefficients(i, cascade[(size_t)i]);
+            cascadeFilter.setBypassed(i, false);
+        }
+
+        processInChunks(parallelOutput.getBlock(), [&](const juce::dsp::AudioBlock<SampleType>& block) { parallelFilter.process(block); });
+        processInChunks(cascadeOutput.getBlock(), [&](const juce::dsp::AudioBlock<SampleType>& block) { cascadeFilter.process(block); });
+
+        return getMaxDifference(parallelOutput, cascadeOutput);
+    }
+};
+
+static ParallelCutFilterTests parallelCutFilterTests;
+
+// BPR -> a 48 dB/oct cut as four parallel sections in one register pass, against the same
+// four sections in series
+
+struct ParallelCutFilterBenchmarks : juce::UnitTest
+{
+    ParallelCutFilterBenchmarks() : juce::UnitTest("ParallelCutFilter", "EQQ Benchmarks") {}
+
+    static constexpr double sampleRate = 48000.0;
+    static constexpr int blockSize = 512;
+    static constexpr int numBlocks = 938;   // 10 s at 48 kHz
+    static constexpr int numRuns = 5;
+
+    void runTest() override
+    {
+        juce::ScopedNoDenormals noDenormals;
+        auto random = getRandom();
+
+        benchmark<float>(random);
+        benchmark<double>(random);
+    }
+
+    template<typename SampleType>
+    void benchmark(juce::Random& random)
+    {
+        beginTest(juce::String("48 dB/oct low pass, parallel against cascade (") + (std::is_same_v<SampleType, float> ? "float)" : "double)"));
+
+        const auto cascade = makeCutCascade(sampleRate, 1000.0, 8, false);
+        const auto sections = makeParallelSections(cascade, 4, sampleRate);
+        expect(sections.isValid);
+
+        // Every block starts from the same noise, so neither side ends up on denormals
+        TestSignal<SampleType> input(random, 2, blockSize);
+        auto output = input;
+        auto block = output.getBlock();
+
+        BasicParallelCutFilter<SampleType> parallelFilter;
+        parallelFilter.prepare(2, sampleRate);
+        parallelFilter.setSections(sections);
+        parallelFilter.setActive(true);
+
+        BasicBiquadCascade<SampleType> cascadeFilter;
+        cascadeFilter.prepare({ sampleRate, (juce::uint32)blockSize, 2 });
+
+        for (int i = 0; i < 4; ++i)
+        {
+            cascadeFilter.setCoefficients(i, cascade[(size_t)i]);
+            cascadeFilter.setBypassed(i, false);
+        }
+
+        const auto parallelTime = getMillisecondsPerRun(numRuns, [&]
+        {
+            for (int i = 0; i < numBlocks; ++i)
+            {
+                block.copyFrom(input.getBlock());
+                parallelFilter.process(block);
+            }
+        });
+
+        const auto cascadeTime = getMillisecondsPerRun(numRuns, [&]
+        {
+            for (int i = 0; i < numBlocks; ++i)
+            {
+                block.copyFrom(input.getBlock());
+                cascadeFilter.process(block);
+            }
+        });
+
+        logMessage("10 s of stereo: parallel " + juce::String(parallelTime, 2) + " ms, cascade " + juce::String(cascadeTime, 2)
+                   + " ms, speedup " + juce::String(cascadeTime / parallelTime, 2) + "x");
+    }
+};
+
+static ParallelCutFilterBenchmarks parallelCutFilterBenchmarks;
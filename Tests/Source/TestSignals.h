@@ -0,0 +1,91 @@
+/*
+  ==============================================================================
+
+    Signals, comparisons and timing shared by the engine tests and benchmarks.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "../../Source/BiquadCascade.h"
+
+#include <vector>
+
+// BPR -> numChannels channels of uniform noise in -1..1, with the pointers an AudioBlock wants
+
+template<typename SampleType>
+struct TestSignal
+{
+    TestSignal(juce::Random& random, int numChannels, int numSamples)
+        : channels((size_t)numChannels, std::vector<SampleType>((size_t)numSamples))
+    {
+        for (auto& channel : channels)
+            for (auto& sample : channel)
+                sample = (SampleType)(random.nextDouble() * 2.0 - 1.0);
+
+        updatePointers();
+    }
+
+    TestSignal(const TestSignal& other) : channels(other.channels) { updatePointers(); }
+
+    juce::dsp::AudioBlock<SampleType> getBlock()
+    {
+        return { pointers.data(), pointers.size(), channels.empty() ? 0 : channels[0].size() };
+    }
+
+    std::vector<std::vector<SampleType>> channels;
+
+private:
+    std::vector<SampleType*> pointers;
+
+    void updatePointers()
+    {
+        pointers.clear();
+
+        for (auto& channel : channels)
+            pointers.push_back(channel.data());
+    }
+};
+
+// BPR -> largest absolute difference between two signals of the same shape
+
+template<typename SampleType>
+double getMaxDifference(const TestSignal<SampleType>& a, const TestSignal<SampleType>& b)
+{
+    double maxDifference = 0.0;
+
+    for (size_t ch = 0; ch < a.channels.size(); ++ch)
+        for (size_t i = 0; i < a.channels[ch].size(); ++i)
+            maxDifference = juce::jmax(maxDifference, std::abs((double)a.channels[ch][i] - (double)b.channels[ch][i]));
+
+    return maxDifference;
+}
+
+// BPR -> runs the block in uneven chunks, so block boundaries get exercised as well
+
+template<typename SampleType, typename ProcessFunction>
+void processInChunks(juce::dsp::AudioBlock<SampleType> block, ProcessFunction&& process)
+{
+    const auto numSamples = block.getNumSamples();
+
+    for (size_t start = 0, chunk = 1; start < numSamples; start += chunk, chunk = chunk * 3 % 509 + 1)
+        process(block.getSubBlock(start, juce::jmin(chunk, numSamples - start)));
+}
+
+// BPR -> average wall clock time of one call, after one call to warm the caches up
+
+template<typename Function>
+double getMillisecondsPerRun(int numRuns, Function&& function)
+{
+    function();
+
+    const auto start = juce::Time::getMillisecondCounterHiRes();
+
+    for (int i = 0; i < numRuns; ++i)
+        function();
+
+    return (juce::Time::getMillisecondCounterHiRes() - start) / numRuns;
+}